@@ -0,0 +1,51 @@
+set(PhysicsBenchmark "PhysicsBenchmark")
+
+set(PhysicsBenchmark_modules
+	ErrorHelpers
+	ForceFields
+	Material
+	MySimulation
+	NBodyGravitation
+	PhysXCpuDispatcher
+	PoseStream
+	Random
+	SceneGenerator
+	ThreadHelpers)
+list(TRANSFORM PhysicsBenchmark_modules PREPEND "Source/")
+list(TRANSFORM PhysicsBenchmark_modules APPEND ".ixx")
+
+add_executable(${PhysicsBenchmark} "Source/PhysicsBenchmark/Main.cpp")
+target_sources(${PhysicsBenchmark} PRIVATE FILE_SET cxx_modules TYPE CXX_MODULES FILES ${PhysicsBenchmark_modules})
+
+set_target_properties(${PhysicsBenchmark} PROPERTIES CXX_STANDARD 23)
+set_target_properties(${PhysicsBenchmark} PROPERTIES CXX_STANDARD_REQUIRED ON)
+
+if(WIN32)
+	target_compile_definitions(${PhysicsBenchmark} PRIVATE NOMINMAX)
+endif()
+
+target_include_directories(${PhysicsBenchmark} PRIVATE "${CMAKE_CURRENT_SOURCE_DIR}/Source")
+
+set(PhysicsBenchmark_packages
+	directxmath
+	nlohmann_json
+	unofficial-omniverse-physx-sdk)
+foreach(package ${PhysicsBenchmark_packages})
+	find_package(${package} CONFIG REQUIRED)
+endforeach()
+find_package(Threads REQUIRED)
+
+target_link_libraries(${PhysicsBenchmark} PRIVATE
+	Microsoft::DirectXMath
+	nlohmann_json::nlohmann_json
+	unofficial::omniverse-physx-sdk::sdk
+	Threads::Threads)
+
+if(NOT WIN32)
+	find_package(directx-headers CONFIG REQUIRED)
+	target_link_libraries(${PhysicsBenchmark} PRIVATE Microsoft::DirectX-Headers)
+endif()
+
+if(CMAKE_CXX_COMPILER_ID STREQUAL "GNU")
+	target_link_libraries(${PhysicsBenchmark} PRIVATE stdc++exp)
+endif()
@@ -26,10 +26,32 @@ struct MeshDescriptors
 
 using TextureMapInfoArray = TextureMapInfo[TextureMapType::Count];
 
-struct ObjectData
+struct MeshData
 {
 	VertexDesc VertexDesc;
 	MeshDescriptors MeshDescriptors;
+};
+
+struct MaterialData
+{
 	Material Material;
 	TextureMapInfoArray TextureMapInfoArray;
 };
+
+StructuredBuffer<MeshData> g_meshData : register(t0, space1);
+StructuredBuffer<MaterialData> g_materialData : register(t1, space1);
+
+struct ObjectData
+{
+	uint MeshIndex, MaterialIndex;
+
+	MeshData GetMeshData()
+	{
+		return g_meshData[MeshIndex];
+	}
+
+	MaterialData GetMaterialData()
+	{
+		return g_materialData[MaterialIndex];
+	}
+};
@@ -69,7 +69,7 @@ float3 CalculateMotionVector(float2 UV, uint2 pixelDimensions, float linearDepth
 	else
 	{
 		previousPosition = hitInfo.ObjectPosition;
-		const MeshDescriptors meshDescriptors = g_objectData[hitInfo.ObjectIndex].MeshDescriptors;
+		const MeshDescriptors meshDescriptors = g_objectData[hitInfo.ObjectIndex].GetMeshData().MeshDescriptors;
 		if (meshDescriptors.MotionVectors != ~0u)
 		{
 			const StructuredBuffer<float16_t4> meshMotionVectors = ResourceDescriptorHeap[meshDescriptors.MotionVectors];
@@ -99,6 +99,8 @@ float3 CalculateMotionVector(float2 UV, uint2 pixelDimensions, float linearDepth
 	"CBV(b2),"
 	"SRV(t1),"
 	"SRV(t2),"
+	"SRV(t0, space = 1),"
+	"SRV(t1, space = 1),"
 	"DescriptorTable(UAV(u0)),"
 	"DescriptorTable(UAV(u1)),"
 	"DescriptorTable(UAV(u2)),"
@@ -154,13 +156,13 @@ void main(uint2 pixelPosition : SV_DispatchThreadID)
 		BSDFSample BSDFSample;
 		if (g_constants.Flags & Flags::Material)
 		{
-			const ObjectData objectData = g_objectData[hitInfo.ObjectIndex];
+			const MaterialData materialData = g_objectData[hitInfo.ObjectIndex].GetMaterialData();
 
 			bool hasSampledTexture;
 			const Material material = EvaluateMaterial(
 				hitInfo.ShadingNormal, hitInfo.GetFrontTangent(),
-				objectData.Material,
-				objectData.TextureMapInfoArray, hitInfo.TextureCoordinates,
+				materialData.Material,
+				materialData.TextureMapInfoArray, hitInfo.TextureCoordinates,
 				hasSampledTexture
 			);
 			BSDFSample.Initialize(material, hitInfo.IsFrontFace);
@@ -56,6 +56,8 @@ bool FindTask(uint dispatchThreadID, out Task task)
 	"SRV(t0),"
 	"SRV(t1),"
 	"SRV(t2),"
+	"SRV(t0, space = 1),"
+	"SRV(t1, space = 1),"
 	"UAV(u0),"
 	"DescriptorTable(UAV(u1))"
 )]
@@ -70,11 +72,13 @@ void main(uint dispatchThreadID : SV_DispatchThreadID)
 
 	const InstanceData instanceData = g_instanceData[task.InstanceIndex];
 	const ObjectData objectData = g_objectData[instanceData.FirstGeometryIndex + task.GeometryIndex];
+	const MeshData meshData = objectData.GetMeshData();
+	const MaterialData materialData = objectData.GetMaterialData();
 
-	const MeshDescriptors meshDescriptors = objectData.MeshDescriptors;
+	const MeshDescriptors meshDescriptors = meshData.MeshDescriptors;
 	const ByteAddressBuffer vertices = ResourceDescriptorHeap[meshDescriptors.Vertices];
 	const uint3 indices = MeshHelpers::Load3Indices(ResourceDescriptorHeap[meshDescriptors.Indices], dispatchThreadID - task.LightBufferOffset);
-	const VertexDesc vertexDesc = objectData.VertexDesc;
+	const VertexDesc vertexDesc = meshData.VertexDesc;
 
 	float3 positions[3];
 	vertexDesc.LoadPositions(vertices, indices, positions);
@@ -82,10 +86,10 @@ void main(uint dispatchThreadID : SV_DispatchThreadID)
 	positions[1] = Geometry::AffineTransform(instanceData.ObjectToWorld, positions[1]);
 	positions[2] = Geometry::AffineTransform(instanceData.ObjectToWorld, positions[2]);
 
-	float3 emission = objectData.Material.GetEmission();
+	float3 emission = materialData.Material.GetEmission();
 	TextureMapInfo textureMapInfo;
 	if (any(emission > 0)
-		&& (textureMapInfo = objectData.TextureMapInfoArray[TextureMapType::EmissiveColor]).Descriptor != ~0u)
+		&& (textureMapInfo = materialData.TextureMapInfoArray[TextureMapType::EmissiveColor]).Descriptor != ~0u)
 	{
 		float2 textureCoordinates[3];
 		vertexDesc.LoadTextureCoordinates(vertices, indices, textureMapInfo.TextureCoordinateIndex, textureCoordinates);
@@ -84,6 +84,8 @@ RWTexture2D<float> g_specularHitDistance : register(u5);
 		"CBV(b0)," \
 		"CBV(b1)," \
 		"SRV(t1)," \
+		"SRV(t0, space = 1)," \
+		"SRV(t1, space = 1)," \
 		"SRV(t2)," \
 		"SRV(t3)," \
 		"DescriptorTable(SRV(t4))," \
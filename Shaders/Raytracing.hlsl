@@ -82,6 +82,8 @@ GlobalRootSignature GlobalRootSignature =
 	"CBV(b1),"
 	"CBV(b2),"
 	"SRV(t1),"
+	"SRV(t0, space = 1),"
+	"SRV(t1, space = 1),"
 	"DescriptorTable(SRV(t2)),"
 	"DescriptorTable(SRV(t3)),"
 	"DescriptorTable(SRV(t4)),"
@@ -292,11 +294,11 @@ void RayGeneration()
 
 			if (bounceIndex)
 			{
-				const ObjectData objectData = g_objectData[hitInfo.ObjectIndex];
+				const MaterialData materialData = g_objectData[hitInfo.ObjectIndex].GetMaterialData();
 				const Material material = EvaluateMaterial(
 					hitInfo.ShadingNormal, hitInfo.GetFrontTangent(),
-					objectData.Material,
-					objectData.TextureMapInfoArray, hitInfo.TextureCoordinates,
+					materialData.Material,
+					materialData.TextureMapInfoArray, hitInfo.TextureCoordinates,
 					hasSampledTexture
 				);
 				emission = isDIValid && bounceIndex == 1 ? 0 : material.GetEmission();
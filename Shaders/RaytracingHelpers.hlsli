@@ -19,25 +19,27 @@ float3 TraceRay(
 		if (q.CandidateType() == CANDIDATE_NON_OPAQUE_TRIANGLE)
 		{
 			const ObjectData objectData = g_objectData[q.CandidateInstanceID() + q.CandidateGeometryIndex()];
-			const MeshDescriptors meshDescriptors = objectData.MeshDescriptors;
+			const MeshData meshData = objectData.GetMeshData();
+			const MeshDescriptors meshDescriptors = meshData.MeshDescriptors;
 			const ByteAddressBuffer vertices = ResourceDescriptorHeap[meshDescriptors.Vertices];
 			const uint3 indices = MeshHelpers::Load3Indices(ResourceDescriptorHeap[meshDescriptors.Indices], q.CandidatePrimitiveIndex());
 			float2 textureCoordinates[2];
 			GetTextureCoordinates(
-				objectData.VertexDesc,
+				meshData.VertexDesc,
 				vertices,
 				indices,
 				q.CandidateTriangleBarycentrics(),
 				textureCoordinates
 			);
+			const MaterialData materialData = objectData.GetMaterialData();
 			if (Flags & RAY_FLAG_ACCEPT_FIRST_HIT_AND_END_SEARCH)
 			{
-				if (IsOpaque(objectData.Material, objectData.TextureMapInfoArray, textureCoordinates, visibility))
+				if (IsOpaque(materialData.Material, materialData.TextureMapInfoArray, textureCoordinates, visibility))
 				{
 					q.CommitNonOpaqueTriangleHit();
 				}
 			}
-			else if (IsOpaque(objectData.Material, objectData.TextureMapInfoArray, textureCoordinates))
+			else if (IsOpaque(materialData.Material, materialData.TextureMapInfoArray, textureCoordinates))
 			{
 				q.CommitNonOpaqueTriangleHit();
 			}
@@ -80,12 +82,12 @@ bool CastRay(
 		hitInfo.PrimitiveIndex = q.CommittedPrimitiveIndex();
 
 		const float3x4 objectToWorld = q.CommittedObjectToWorld3x4();
-		const ObjectData objectData = g_objectData[hitInfo.ObjectIndex];
+		const MeshData meshData = g_objectData[hitInfo.ObjectIndex].GetMeshData();
 
-		const MeshDescriptors meshDescriptors = objectData.MeshDescriptors;
+		const MeshDescriptors meshDescriptors = meshData.MeshDescriptors;
 		const ByteAddressBuffer vertices = ResourceDescriptorHeap[meshDescriptors.Vertices];
 		const uint3 indices = MeshHelpers::Load3Indices(ResourceDescriptorHeap[meshDescriptors.Indices], hitInfo.PrimitiveIndex);
-		const VertexDesc vertexDesc = objectData.VertexDesc;
+		const VertexDesc vertexDesc = meshData.VertexDesc;
 
 		float3 positions[3];
 		vertexDesc.LoadPositions(vertices, indices, positions);
@@ -122,7 +124,7 @@ bool CastRay(
 		}
 
 		GetTextureCoordinates(
-			objectData.VertexDesc,
+			vertexDesc,
 			vertices,
 			indices,
 			q.CommittedTriangleBarycentrics(),
@@ -2,10 +2,16 @@
 
 #include "Packing.hlsli"
 
+enum DXGI_FORMAT
+{
+	DXGI_FORMAT_R32G32B32_FLOAT = 6,
+	DXGI_FORMAT_R16G16B16A16_SNORM = 13
+};
+
 struct VertexDesc
 {
-	uint Stride;
-	uint3 _;
+	uint Stride, PositionFormat;
+	uint2 _;
 	struct
 	{
 		uint Normal, Tangent, TextureCoordinates[2];
@@ -13,6 +19,10 @@ struct VertexDesc
 
 	float3 LoadPosition(ByteAddressBuffer buffer, uint index)
 	{
+		if (PositionFormat == DXGI_FORMAT_R16G16B16A16_SNORM)
+		{
+			return Unpack_R16G16B16_SNORM(buffer.Load<int16_t3>(Stride * index));
+		}
 		return buffer.Load<float3>(Stride * index);
 	}
 
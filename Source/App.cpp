@@ -48,7 +48,9 @@ import GPUBuffer;
 import HaltonSampler;
 import LightPreparation;
 import Material;
+import Model;
 import MyScene;
+import ProceduralScene;
 import PostProcessing.Bloom;
 import PostProcessing.MipmapGeneration;
 import PostProcessing.NRDComposition;
@@ -56,6 +58,7 @@ import Raytracing;
 import RTXDI;
 import RTXDIResources;
 import RTXGI;
+import SceneFile;
 import SharedData;
 import StepTimer;
 import StringConverters;
@@ -81,6 +84,7 @@ namespace {
 	constexpr auto& g_graphicsSettings = MyAppData::Settings::Graphics;
 	constexpr auto& g_UISettings = MyAppData::Settings::UI;
 	constexpr auto& g_controlsSettings = MyAppData::Settings::Controls;
+	constexpr auto& g_physicsSettings = MyAppData::Settings::Physics;
 }
 
 #define MAKE_NAME(Name) static constexpr LPCSTR Name = #Name;
@@ -122,6 +126,30 @@ struct App::Impl : IDeviceNotify {
 
 		windowModeHelper.SetFullscreenResolutionHandledByWindow(false);
 
+		if (const auto& visualDebuggerSettings = g_physicsSettings.VisualDebugger; visualDebuggerSettings.IsEnabled) {
+			using namespace physx;
+
+			const auto& [IsDebugEnabled, IsProfileEnabled, IsMemoryEnabled] = visualDebuggerSettings.Instrumentation;
+			PxPvdInstrumentationFlags instrumentationFlags;
+			if (IsDebugEnabled) {
+				instrumentationFlags |= PxPvdInstrumentationFlag::eDEBUG;
+			}
+			if (IsProfileEnabled) {
+				instrumentationFlags |= PxPvdInstrumentationFlag::ePROFILE;
+			}
+			if (IsMemoryEnabled) {
+				instrumentationFlags |= PxPvdInstrumentationFlag::eMEMORY;
+			}
+
+			ignore = PhysX::EnableVisualDebugger({
+				.Transport = visualDebuggerSettings.Transport,
+				.Host = visualDebuggerSettings.Host,
+				.Port = visualDebuggerSettings.Port,
+				.FilePath = visualDebuggerSettings.CaptureFilePath,
+				.InstrumentationFlags = instrumentationFlags
+			});
+		}
+
 		LoadScene();
 	}
 
@@ -365,14 +393,72 @@ private:
 	};
 	unordered_map<wstring, shared_ptr<Texture>> m_textures;
 
-	struct { unique_ptr<GPUBuffer> Camera, SceneData, InstanceData, ObjectData; } m_GPUBuffers;
+	struct { unique_ptr<GPUBuffer> Camera, SceneData, InstanceData, ObjectData, MeshData, MaterialData; } m_GPUBuffers;
+
+	template <typename T>
+	struct SceneDataTable {
+		vector<T> Data;
+		vector<uint32_t> ReferenceCounts, FreeIndices, DirtyIndices;
+		unordered_multimap<size_t, uint32_t> Indices;
+
+		static size_t Hash(const T& value) { return std::hash<string_view>()({ reinterpret_cast<const char*>(&value), sizeof(value) }); }
+
+		uint32_t Add(const T& value) {
+			const auto hash = Hash(value);
+			for (auto [pIndex, pEnd] = Indices.equal_range(hash); pIndex != pEnd; ++pIndex) {
+				if (!memcmp(&Data[pIndex->second], &value, sizeof(value))) {
+					ReferenceCounts[pIndex->second]++;
+					return pIndex->second;
+				}
+			}
+
+			uint32_t index;
+			if (empty(FreeIndices)) {
+				index = static_cast<uint32_t>(size(Data));
+				Data.emplace_back(value);
+				ReferenceCounts.emplace_back(1);
+			}
+			else {
+				index = FreeIndices.back();
+				FreeIndices.pop_back();
+				Data[index] = value;
+				ReferenceCounts[index] = 1;
+			}
+			Indices.emplace(hash, index);
+			DirtyIndices.emplace_back(index);
+			return index;
+		}
+
+		void Release(uint32_t index) {
+			if (--ReferenceCounts[index]) {
+				return;
+			}
+
+			for (auto [pIndex, pEnd] = Indices.equal_range(Hash(Data[index])); pIndex != pEnd; ++pIndex) {
+				if (pIndex->second == index) {
+					Indices.erase(pIndex);
+					break;
+				}
+			}
+			FreeIndices.emplace_back(index);
+		}
+	};
+
+	struct {
+		vector<InstanceData> Instances;
+		vector<ObjectData> Objects;
+		vector<uint32_t> ObjectGenerations;
+		SceneDataTable<MeshData> Meshes;
+		SceneDataTable<MaterialData> Materials;
+		uint64_t UploadSize;
+	} m_sceneDataUploadCache{};
 
 	Camera m_camera;
 	CameraController m_cameraController;
 
 	unique_ptr<Scene> m_scene;
 
-	struct { bool IsVisible, HasFocus = true, IsSettingsWindowOpen; } m_UIStates{};
+	struct { bool IsVisible, HasFocus = true, IsSettingsWindowOpen, IsStatisticsWindowOpen; } m_UIStates{};
 	vector<unique_ptr<Descriptor>> m_ImGUIDescriptors;
 
 	void CreateDeviceDependentResources() {
@@ -684,8 +770,61 @@ private:
 	void LoadScene() {
 		m_futures[FutureNames::Scene] = StartDetachedFuture([&] {
 			try {
-			m_scene = make_unique<MyScene>(m_deviceResources->GetDeviceContext());
-			m_scene->Load(MySceneDesc());
+			vector<LPCWSTR> arguments;
+			auto poseStreamMode = Scene::PoseStreamMode::None;
+			filesystem::path poseStreamFilePath;
+			for (int i = 1; i < __argc; i++) {
+				if (i + 1 < __argc && !_wcsicmp(__wargv[i], L"--record-poses")) {
+					poseStreamMode = Scene::PoseStreamMode::Record;
+					poseStreamFilePath = __wargv[++i];
+				}
+				else if (i + 1 < __argc && !_wcsicmp(__wargv[i], L"--replay-poses")) {
+					poseStreamMode = Scene::PoseStreamMode::Replay;
+					poseStreamFilePath = __wargv[++i];
+				}
+				else {
+					arguments.emplace_back(__wargv[i]);
+				}
+			}
+
+			if (!empty(arguments) && !_wcsicmp(arguments[0], L"--procedural")) {
+				const auto ParseNumber = [](wstring_view value) -> optional<uint32_t> {
+					uint64_t number = 0;
+					if (empty(value) || size(value) > 10) {
+						return nullopt;
+					}
+					for (const auto c : value) {
+						if (c < L'0' || c > L'9') {
+							return nullopt;
+						}
+						number = number * 10 + static_cast<uint64_t>(c - L'0');
+					}
+					return number <= numeric_limits<uint32_t>::max() ? optional(static_cast<uint32_t>(number)) : nullopt;
+				};
+				const auto objectCount = size(arguments) > 1 ? ParseNumber(arguments[1]) : nullopt;
+				const auto seed = size(arguments) > 2 ? ParseNumber(arguments[2]) : optional(0u);
+				if (!objectCount || !*objectCount || !seed) {
+					Throw<invalid_argument>("Usage: --procedural <object count (>= 1)> [seed]");
+				}
+
+				m_scene = make_unique<ProceduralScene>(m_deviceResources->GetDeviceContext());
+				m_scene->SetPoseStream(poseStreamMode, poseStreamFilePath);
+				m_scene->Load(ProceduralSceneDesc({
+					.GridSize = static_cast<UINT>(ceil(sqrt(static_cast<double>(*objectCount)))),
+					.ObjectCount = *objectCount,
+					.Seed = *seed
+				}));
+			}
+			else if (!empty(arguments)) {
+				m_scene = make_unique<FileScene>(m_deviceResources->GetDeviceContext());
+				m_scene->SetPoseStream(poseStreamMode, poseStreamFilePath);
+				m_scene->Load(FileSceneDesc(arguments[0]));
+			}
+			else {
+				m_scene = make_unique<MyScene>(m_deviceResources->GetDeviceContext());
+				m_scene->SetPoseStream(poseStreamMode, poseStreamFilePath);
+				m_scene->Load(MySceneDesc());
+			}
 
 			OnSceneLoaded();
 		}
@@ -807,6 +946,10 @@ private:
 		if (const auto objectCount = m_scene->GetObjectCount()) {
 			CreateBuffer(ObjectData(), m_GPUBuffers.ObjectData, objectCount);
 		}
+		m_GPUBuffers.MeshData.reset();
+		m_GPUBuffers.MaterialData.reset();
+
+		m_sceneDataUploadCache = {};
 	}
 
 	void ProcessInput() {
@@ -970,10 +1113,20 @@ private:
 	}
 
 	void UpdateScene() {
+		if (!m_scene->IsStatic()) {
+			m_scene->SelectLODs(m_cameraController.GetPosition());
+		}
+
 		m_scene->Tick(m_stepTimer.GetElapsedSeconds(), m_inputDeviceStateTrackers.Gamepad, m_inputDeviceStateTrackers.Keyboard, m_inputDeviceStateTrackers.Mouse);
 
 		auto& commandList = m_deviceResources->GetCommandList();
 
+		{
+			auto& textureResidencyManager = m_scene->GetTextureResidencyManager();
+			textureResidencyManager.Budget = static_cast<uint64_t>(g_graphicsSettings.TextureStreaming.Budget) << 20;
+			m_scene->UpdateTextureResidency(commandList, m_cameraController.GetPosition(), static_cast<float>(GetOutputSize().cy) / (2 * tan(m_cameraController.GetVerticalFieldOfView() / 2)));
+		}
+
 		{
 			SceneData sceneData{
 				.IsStatic = m_scene->IsStatic(),
@@ -987,45 +1140,123 @@ private:
 			commandList.Copy(*m_GPUBuffers.SceneData, initializer_list{ sceneData });
 		}
 
-		vector<InstanceData> instanceData(size(m_scene->GetInstanceData()));
-		vector<ObjectData> objectData(m_scene->GetObjectCount());
-		for (uint32_t instanceIndex = 0; const auto & renderObject : m_scene->RenderObjects) {
-			const auto& _instanceData = m_scene->GetInstanceData()[instanceIndex];
-			instanceData[instanceIndex++] = {
-				.FirstGeometryIndex = _instanceData.FirstGeometryIndex,
-				.PreviousObjectToWorld = _instanceData.PreviousObjectToWorld,
-				.ObjectToWorld = _instanceData.ObjectToWorld
-			};
+		auto& [instanceData, objectData, objectGenerations, meshTable, materialTable, uploadSize] = m_sceneDataUploadCache;
 
-			const auto& mesh = renderObject.Mesh;
+		constexpr size_t MaxGap = 16;
+		const auto AddDirtyRange = [&]<typename T>(T, vector<BufferRange>& ranges, size_t index) {
+			if (!empty(ranges)) {
+				if (auto& range = ranges.back(); sizeof(T) * index <= range.Offset + range.Size + sizeof(T) * MaxGap) {
+					range.Size = sizeof(T) * (index + 1) - range.Offset;
+					return;
+				}
+			}
+			ranges.emplace_back(BufferRange{ sizeof(T) * index, sizeof(T) });
+		};
+
+		vector<BufferRange> instanceDataRanges, objectDataRanges;
+
+		const auto& _instanceData = m_scene->GetInstanceData();
+		const auto& dirtyInstanceFlags = m_scene->GetDirtyInstanceFlags();
+		const auto isInstanceDataResized = size(instanceData) != size(_instanceData);
+		instanceData.resize(size(_instanceData));
+		for (size_t i = 0; i < size(_instanceData); i++) {
+			if (isInstanceDataResized || dirtyInstanceFlags[i]) {
+				instanceData[i] = {
+					.FirstGeometryIndex = _instanceData[i].FirstGeometryIndex,
+					.PreviousObjectToWorld = _instanceData[i].PreviousObjectToWorld,
+					.ObjectToWorld = _instanceData[i].ObjectToWorld
+				};
+				AddDirtyRange(InstanceData(), instanceDataRanges, i);
+			}
+		}
+		m_scene->ClearDirtyInstanceFlags();
 
-			auto& _objectData = objectData[_instanceData.FirstGeometryIndex];
+		objectData.resize(m_scene->GetObjectCount());
+		objectGenerations.resize(size(objectData), ~0u);
+		for (uint32_t instanceIndex = 0; const auto & renderObject : m_scene->RenderObjects) {
+			const auto objectIndex = _instanceData[instanceIndex++].FirstGeometryIndex;
 
-			_objectData.VertexDesc = mesh->GetVertexDesc();
+			if (objectGenerations[objectIndex] == renderObject.Generation) {
+				continue;
+			}
+			const auto isObjectDataValid = objectGenerations[objectIndex] != ~0u;
+			objectGenerations[objectIndex] = renderObject.Generation;
 
-			_objectData.Material = renderObject.Material;
+			const auto& mesh = renderObject.Mesh;
 
-			_objectData.MeshDescriptors = {
-				.Vertices = mesh->Vertices->GetSRVDescriptor(BufferSRVType::Raw),
-				.Indices = mesh->Indices->GetSRVDescriptor(BufferSRVType::Typed)
-			};
+			auto& _objectData = objectData[objectIndex];
+			const auto previousObjectData = _objectData;
 
+			_objectData.MeshIndex = meshTable.Add(MeshData{
+				.VertexDesc = mesh->GetVertexDesc(),
+				.MeshDescriptors{
+					.Vertices = mesh->Vertices->GetSRVDescriptor(BufferSRVType::Raw),
+					.Indices = mesh->Indices->GetSRVDescriptor(BufferSRVType::Typed)
+				}
+			});
+
+			MaterialData _materialData{ .Material = renderObject.Material };
 			for (uint32_t i = 0;
 				const auto & texture : renderObject.Textures) {
 				if (texture) {
-					_objectData.TextureMapInfoArray[i] = {
+					_materialData.TextureMapInfoArray[i] = {
 						.Descriptor = texture->GetSRVDescriptor().GetIndex()
 					};
 				}
 				i++;
 			}
+			_objectData.MaterialIndex = materialTable.Add(_materialData);
+
+			if (isObjectDataValid) {
+				meshTable.Release(previousObjectData.MeshIndex);
+				materialTable.Release(previousObjectData.MaterialIndex);
+			}
+
+			AddDirtyRange(ObjectData(), objectDataRanges, objectIndex);
 		}
+
+		uploadSize = 0;
 		if (m_GPUBuffers.InstanceData) {
-			commandList.Copy(*m_GPUBuffers.InstanceData, instanceData);
+			commandList.Copy(*m_GPUBuffers.InstanceData, data(instanceData), instanceDataRanges);
+			for (const auto& range : instanceDataRanges) {
+				uploadSize += range.Size;
+			}
 		}
 		if (m_GPUBuffers.ObjectData) {
-			commandList.Copy(*m_GPUBuffers.ObjectData, objectData);
+			commandList.Copy(*m_GPUBuffers.ObjectData, data(objectData), objectDataRanges);
+			for (const auto& range : objectDataRanges) {
+				uploadSize += range.Size;
+			}
 		}
+
+		const auto UploadTable = [&]<typename T>(unique_ptr<GPUBuffer>& buffer, SceneDataTable<T>& table) {
+			auto& dirtyIndices = table.DirtyIndices;
+			if (empty(dirtyIndices)) {
+				return;
+			}
+
+			vector<BufferRange> tableRanges;
+			if (!buffer || buffer->GetCapacity() < size(table.Data)) {
+				const auto capacity = max(size(table.Data), buffer ? buffer->GetCapacity() * 2 : 0);
+				commandList.Retire(move(buffer));
+				buffer = GPUBuffer::CreateDefault<T>(m_deviceResources->GetDeviceContext(), capacity);
+				tableRanges.emplace_back(BufferRange{ 0, sizeof(T) * size(table.Data) });
+			}
+			else {
+				ranges::sort(dirtyIndices);
+				for (const auto index : dirtyIndices) {
+					AddDirtyRange(T(), tableRanges, index);
+				}
+			}
+			dirtyIndices.clear();
+
+			commandList.Copy(*buffer, data(table.Data), tableRanges);
+			for (const auto& range : tableRanges) {
+				uploadSize += range.Size;
+			}
+		};
+		UploadTable(m_GPUBuffers.MeshData, meshTable);
+		UploadTable(m_GPUBuffers.MaterialData, materialTable);
 	}
 
 	void PrepareLightResources() {
@@ -1056,6 +1287,8 @@ private:
 				m_lightPreparation->GPUBuffers = {
 					.InstanceData = m_GPUBuffers.InstanceData.get(),
 					.ObjectData = m_GPUBuffers.ObjectData.get(),
+					.MeshData = m_GPUBuffers.MeshData.get(),
+					.MaterialData = m_GPUBuffers.MaterialData.get(),
 					.LightInfo = m_RTXDIResources.LightInfo.get()
 				};
 
@@ -1151,7 +1384,9 @@ private:
 				.SceneData = m_GPUBuffers.SceneData.get(),
 				.Camera = m_GPUBuffers.Camera.get(),
 				.InstanceData = m_GPUBuffers.InstanceData.get(),
-				.ObjectData = m_GPUBuffers.ObjectData.get()
+				.ObjectData = m_GPUBuffers.ObjectData.get(),
+				.MeshData = m_GPUBuffers.MeshData.get(),
+				.MaterialData = m_GPUBuffers.MaterialData.get()
 			};
 
 			m_GBufferGeneration->Textures = {
@@ -1194,7 +1429,9 @@ private:
 
 				m_RTXDI->GPUBuffers = {
 				.Camera = m_GPUBuffers.Camera.get(),
-				.ObjectData = m_GPUBuffers.ObjectData.get()
+				.ObjectData = m_GPUBuffers.ObjectData.get(),
+				.MeshData = m_GPUBuffers.MeshData.get(),
+				.MaterialData = m_GPUBuffers.MaterialData.get()
 				};
 
 				m_RTXDI->Textures = {
@@ -1235,7 +1472,9 @@ private:
 		m_raytracing->GPUBuffers = {
 			.SceneData = m_GPUBuffers.SceneData.get(),
 			.Camera = m_GPUBuffers.Camera.get(),
-			.ObjectData = m_GPUBuffers.ObjectData.get()
+			.ObjectData = m_GPUBuffers.ObjectData.get(),
+			.MeshData = m_GPUBuffers.MeshData.get(),
+			.MaterialData = m_GPUBuffers.MaterialData.get()
 		};
 
 		m_raytracing->Textures = {
@@ -1791,6 +2030,10 @@ private:
 			RenderSettingsWindow();
 		}
 
+		if (m_UIStates.IsStatisticsWindowOpen) {
+			RenderStatisticsWindow();
+		}
+
 		RenderPopupModalWindow(popupModalName);
 
 		if (IsSceneLoading()) {
@@ -1822,6 +2065,8 @@ private:
 
 			if (ImGuiEx::Menu menu("View"); menu) {
 				m_UIStates.IsSettingsWindowOpen |= ImGui::MenuItem("Settings");
+
+				m_UIStates.IsStatisticsWindowOpen |= ImGui::MenuItem("Statistics");
 			}
 
 			if (ImGuiEx::Menu menu("Help"); menu) {
@@ -1926,6 +2171,12 @@ private:
 					}
 				}
 
+				if (ImGuiEx::TreeNode treeNode("Texture Streaming", ImGuiTreeNodeFlags_DefaultOpen); treeNode) {
+					auto& textureStreamingSettings = g_graphicsSettings.TextureStreaming;
+
+					ImGui::SliderInt("Budget", reinterpret_cast<int*>(&textureStreamingSettings.Budget), textureStreamingSettings.MinBudget, textureStreamingSettings.MaxBudget, "%u MB", ImGuiSliderFlags_AlwaysClamp | ImGuiSliderFlags_Logarithmic);
+				}
+
 				if (ImGuiEx::TreeNode treeNode("Raytracing", ImGuiTreeNodeFlags_DefaultOpen); treeNode) {
 					auto& raytracingSettings = g_graphicsSettings.Raytracing;
 
@@ -2328,7 +2579,8 @@ private:
 				{ "D-Pad Up Down", "Change camera movement speed" },
 				{ "A", "Run/pause physics simulation" },
 				{ "B", "Toggle gravity of Earth" },
-				{ "Y", "Toggle gravity of the star" }
+				{ "Y", "Toggle gravity of the star" },
+				{ "RB", "Toggle mutual gravitation of all objects" }
 			}
 		);
 
@@ -2343,7 +2595,8 @@ private:
 				{ "W A S D", "Move" },
 				{ "Space", "Run/pause physics simulation" },
 				{ "G", "Toggle gravity of Earth" },
-				{ "H", "Toggle gravity of the star" }
+				{ "H", "Toggle gravity of the star" },
+				{ "N", "Toggle mutual gravitation of all objects" }
 			}
 		);
 
@@ -2371,6 +2624,67 @@ private:
 		);
 	}
 
+	void RenderStatisticsWindow() {
+		ImGui::SetNextWindowBgAlpha(g_UISettings.WindowOpacity);
+
+		const auto& viewport = *ImGui::GetMainViewport();
+		ImGui::SetNextWindowPos({ viewport.WorkPos.x + viewport.WorkSize.x, viewport.WorkPos.y }, ImGuiCond_Always, { 1, 0 });
+		ImGui::SetNextWindowSize({});
+
+		if (ImGuiEx::Window window("Statistics", &m_UIStates.IsStatisticsWindowOpen, ImGuiWindowFlags_HorizontalScrollbar); window) {
+			if (!IsSceneReady()) {
+				return;
+			}
+
+			if (ImGuiEx::TreeNode treeNode("Uploads", ImGuiTreeNodeFlags_DefaultOpen); treeNode) {
+				ImGui::Text("Scene Data: %.2f KB", static_cast<double>(m_sceneDataUploadCache.UploadSize) / (1 << 10));
+			}
+
+			if (ImGuiEx::TreeNode treeNode("Top-Level Acceleration Structure", ImGuiTreeNodeFlags_DefaultOpen); treeNode) {
+				const auto& statistics = m_scene->GetRefitPolicyStatistics();
+				ImGui::Text("Rebuilds: %llu", statistics.RebuildCount);
+				ImGui::Text("Refits: %llu", statistics.RefitCount);
+			}
+
+			if (ImGuiEx::TreeNode treeNode("Meshes", ImGuiTreeNodeFlags_DefaultOpen); treeNode) {
+				const auto& statistics = m_scene->GetMeshRegistryStatistics();
+				ImGui::Text("Registered: %zu", statistics.RegisteredMeshCount);
+				ImGui::Text("Unique: %zu", statistics.UniqueMeshCount);
+				ImGui::Text("Deduplicated: %.2f MB", static_cast<double>(statistics.DeduplicatedByteSize) / (1 << 20));
+
+				for (const auto& [URI, mesh] : m_scene->Meshes) {
+					const auto& [LODError, OptimizationReport] = m_scene->MeshMetadata.at(URI);
+					ImGui::Text("%s: %u triangles, error %.4f", URI.c_str(), static_cast<uint32_t>(mesh->Indices->GetCapacity() / 3), LODError);
+					if (OptimizationReport) {
+						const auto& [before, after] = *OptimizationReport;
+						ImGui::Text("\tACMR %.3f -> %.3f, ATVR %.3f -> %.3f", before.ACMR, after.ACMR, before.ATVR, after.ATVR);
+					}
+				}
+			}
+
+			if (ImGuiEx::TreeNode treeNode("Textures", ImGuiTreeNodeFlags_DefaultOpen); treeNode) {
+				const auto& statistics = m_scene->GetTextureCacheStatistics();
+				ImGui::Text("Requests: %llu", statistics.RequestCount);
+				ImGui::Text("Hit Rate: %.1f%%", statistics.RequestCount ? 100.0 * static_cast<double>(statistics.HitCount) / static_cast<double>(statistics.RequestCount) : 0.0);
+				ImGui::Text("Saved: %.2f MB", static_cast<double>(statistics.SavedByteSize) / (1 << 20));
+
+				const auto& residencyStatistics = m_scene->GetTextureResidencyManager().GetStatistics();
+				ImGui::Text("Resident: %.2f MB", static_cast<double>(residencyStatistics.ResidentByteSize) / (1 << 20));
+				ImGui::Text("Requested: %.2f MB", static_cast<double>(residencyStatistics.RequestedByteSize) / (1 << 20));
+				ImGui::Text("Streaming: %zu", residencyStatistics.StreamingCount);
+				ImGui::Text("Streamed: %zu, Evicted: %zu", residencyStatistics.StreamedCount, residencyStatistics.EvictedCount);
+			}
+
+			if (ImGuiEx::TreeNode treeNode("Tasks", ImGuiTreeNodeFlags_DefaultOpen); treeNode) {
+				const auto statistics = TaskScheduler::Get().GetStatistics();
+				ImGui::Text("Threads: %zu", statistics.ThreadCount);
+				ImGui::Text("Queue Depth: %zu (Max %zu)", statistics.QueueDepth, statistics.MaxQueueDepth);
+				ImGui::Text("Submitted: %llu, Executed: %llu", statistics.SubmittedCount, statistics.ExecutedCount);
+				ImGui::Text("Stolen: %llu", statistics.StolenCount);
+			}
+		}
+	}
+
 	void RenderLoadingSceneWindow() {
 		ImGui::SetNextWindowPos(ImGui::GetMainViewport()->GetWorkCenter(), ImGuiCond_Always, { 0.5f, 0.5f });
 		ImGui::SetNextWindowSize({});
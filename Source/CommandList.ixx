@@ -1,5 +1,6 @@
 module;
 
+#include <memory>
 #include <span>
 #include <stdexcept>
 #include <unordered_set>
@@ -21,12 +22,14 @@ import ErrorHelpers;
 import GPUBuffer;
 import GPUResource;
 import Texture;
+import ThreadHelpers;
 
 using namespace D3D12MA;
 using namespace ErrorHelpers;
 using namespace Microsoft::WRL;
 using namespace Microsoft::WRL::Wrappers;
 using namespace std;
+using namespace ThreadHelpers;
 
 #define COPY() \
 	if (sizeof(T) != buffer.GetStride()) { \
@@ -37,6 +40,11 @@ using namespace std;
 export namespace DirectX {
 	class CommandList {
 	public:
+		struct SubresourceUpload {
+			GPUResource* Resource;
+			span<const D3D12_SUBRESOURCE_DATA> SubresourceData;
+		};
+
 		CommandList(const CommandList&) = delete;
 		CommandList& operator=(const CommandList&) = delete;
 
@@ -77,6 +85,8 @@ export namespace DirectX {
 		const DeviceContext& GetDeviceContext() const noexcept { return m_deviceContext; }
 
 		void Begin() {
+			ReleaseRetiredResources();
+
 			ThrowIfFailed(m_commandAllocator->Reset());
 			ThrowIfFailed(m_commandList->Reset(m_commandAllocator.Get(), nullptr));
 
@@ -91,6 +101,7 @@ export namespace DirectX {
 
 			ThrowIfFailed(m_commandList->Close());
 			m_deviceContext.CommandQueue->ExecuteCommandLists(1, CommandListCast(m_commandList.GetAddressOf()));
+			ThrowIfFailed(m_deviceContext.CommandQueue->Signal(m_fence.Get(), ++m_fenceValue));
 
 			if (!empty(m_compactAccelerationStructureIDs[1])) {
 				m_compactAccelerationStructureIDs[0].append_range(m_compactAccelerationStructureIDs[1]);
@@ -112,12 +123,20 @@ export namespace DirectX {
 
 			m_trackedAllocations.clear();
 
+			ReleaseRetiredResources();
+
 			if (!empty(m_builtAccelerationStructureIDs)) {
 				m_deviceContext.AccelerationStructureManager->GarbageCollection(m_builtAccelerationStructureIDs);
 				m_builtAccelerationStructureIDs.clear();
 			}
 		}
 
+		void Retire(shared_ptr<void> resource) {
+			if (resource) {
+				m_retiredResources.emplace_back(m_fenceValue + 1, move(resource));
+			}
+		}
+
 		void SetDescriptorHeaps() {
 			const auto descriptorHeap = m_deviceContext.ResourceDescriptorHeap->Heap();
 			m_commandList->SetDescriptorHeaps(1, &descriptorHeap);
@@ -152,6 +171,65 @@ export namespace DirectX {
 			m_trackedAllocations.emplace_back(allocation);
 		}
 
+		void Copy(span<const SubresourceUpload> uploads) {
+			if (empty(uploads)) {
+				return;
+			}
+
+			struct Footprints {
+				vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> Layouts;
+				vector<UINT> RowCounts;
+				vector<UINT64> RowSizes;
+			};
+			vector<Footprints> footprints(size(uploads));
+			UINT64 uploadSize = 0;
+			for (size_t i = 0; const auto& [Resource, SubresourceData] : uploads) {
+				const auto subresourceCount = static_cast<UINT>(size(SubresourceData));
+				auto& [Layouts, RowCounts, RowSizes] = footprints[i++];
+				Layouts.resize(subresourceCount);
+				RowCounts.resize(subresourceCount);
+				RowSizes.resize(subresourceCount);
+				const auto desc = (*Resource)->GetDesc();
+				UINT64 size;
+				uploadSize = D3DX12Align<UINT64>(uploadSize, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+				m_deviceContext.Device->GetCopyableFootprints(&desc, 0, subresourceCount, uploadSize, data(Layouts), data(RowCounts), data(RowSizes), &size);
+				uploadSize += size;
+			}
+
+			const auto allocation = CreateUploadBuffer(uploadSize);
+			const auto resource = allocation->GetResource();
+
+			constexpr D3D12_RANGE readRange{};
+			void* pData;
+			ThrowIfFailed(resource->Map(0, &readRange, &pData));
+			ParallelFor(size(uploads), 1, [&](size_t first, size_t last) {
+				for (auto i = first; i < last; i++) {
+					const auto& [Layouts, RowCounts, RowSizes] = footprints[i];
+					for (size_t j = 0; const auto& subresourceData : uploads[i].SubresourceData) {
+						const auto& layout = Layouts[j];
+						const D3D12_MEMCPY_DEST destination{
+							.pData = static_cast<std::byte*>(pData) + layout.Offset,
+							.RowPitch = layout.Footprint.RowPitch,
+							.SlicePitch = static_cast<SIZE_T>(layout.Footprint.RowPitch) * RowCounts[j]
+						};
+						MemcpySubresource(&destination, &subresourceData, static_cast<SIZE_T>(RowSizes[j]), RowCounts[j], layout.Footprint.Depth);
+						j++;
+					}
+				}
+			});
+			resource->Unmap(0, nullptr);
+
+			for (size_t i = 0; const auto& [Resource, SubresourceData] : uploads) {
+				SetState(*Resource, D3D12_RESOURCE_STATE_COPY_DEST);
+				for (UINT j = 0; const auto& layout : footprints[i++].Layouts) {
+					const CD3DX12_TEXTURE_COPY_LOCATION destination(*Resource, j++), source(resource, layout);
+					(*this)->CopyTextureRegion(&destination, 0, 0, 0, &source, nullptr);
+				}
+			}
+
+			m_trackedAllocations.emplace_back(allocation);
+		}
+
 		void Clear(GPUBuffer& buffer, UINT value = 0) {
 			SetState(buffer, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
 			(*this)->ClearUnorderedAccessViewUint(buffer.GetUAVDescriptor(BufferUAVType::Raw), buffer.GetUAVDescriptor(BufferUAVType::Clear), buffer, data(initializer_list{ value, value, value, value }), 0, nullptr);
@@ -174,7 +252,7 @@ export namespace DirectX {
 			const auto bufferRange = BufferRange{ offset, size }.Resolve(buffer->GetDesc().Width);
 
 			if (buffer.IsMappable()) {
-				memcpy(buffer.GetMappedData(), pData, bufferRange.Size);
+				memcpy(static_cast<std::byte*>(buffer.GetMappedData()) + bufferRange.Offset, pData, bufferRange.Size);
 
 				return;
 			}
@@ -193,6 +271,46 @@ export namespace DirectX {
 			m_trackedAllocations.emplace_back(allocation);
 		}
 
+		void Copy(GPUBuffer& buffer, const void* pData, span<const BufferRange> ranges) {
+			if (empty(ranges)) {
+				return;
+			}
+
+			const auto bufferSize = buffer->GetDesc().Width;
+
+			if (buffer.IsMappable()) {
+				for (const auto& range : ranges) {
+					const auto bufferRange = range.Resolve(bufferSize);
+					memcpy(static_cast<std::byte*>(buffer.GetMappedData()) + bufferRange.Offset, static_cast<const std::byte*>(pData) + bufferRange.Offset, bufferRange.Size);
+				}
+
+				return;
+			}
+
+			UINT64 uploadSize = 0;
+			for (const auto& range : ranges) {
+				uploadSize += range.Resolve(bufferSize).Size;
+			}
+
+			const auto allocation = CreateUploadBuffer(uploadSize);
+			const auto resource = allocation->GetResource();
+
+			constexpr D3D12_RANGE readRange{};
+			void* data;
+			ThrowIfFailed(resource->Map(0, &readRange, &data));
+
+			SetState(buffer, D3D12_RESOURCE_STATE_COPY_DEST);
+			UINT64 offset = 0;
+			for (const auto& range : ranges) {
+				const auto bufferRange = range.Resolve(bufferSize);
+				memcpy(static_cast<std::byte*>(data) + offset, static_cast<const std::byte*>(pData) + bufferRange.Offset, bufferRange.Size);
+				(*this)->CopyBufferRegion(buffer, bufferRange.Offset, resource, offset, bufferRange.Size);
+				offset += bufferRange.Size;
+			}
+
+			m_trackedAllocations.emplace_back(allocation);
+		}
+
 		template <typename T>
 		void Copy(GPUBuffer& buffer, initializer_list<T> data, size_t offset = 0) { COPY(); }
 
@@ -256,15 +374,22 @@ export namespace DirectX {
 
 		ComPtr<Pool> m_pool;
 
-		UINT m_fenceValue{};
+		UINT64 m_fenceValue{};
 		ComPtr<ID3D12Fence> m_fence;
 		Event m_fenceEvent;
 
 		unordered_set<GPUResource*> m_trackedResources;
 		vector<ComPtr<Allocation>> m_trackedAllocations;
 
+		vector<pair<UINT64, shared_ptr<void>>> m_retiredResources;
+
 		vector<uint64_t> m_builtAccelerationStructureIDs, m_compactAccelerationStructureIDs[2];
 
+		void ReleaseRetiredResources() {
+			const auto completedValue = m_fence->GetCompletedValue();
+			erase_if(m_retiredResources, [&](const auto& retiredResource) { return retiredResource.first <= completedValue; });
+		}
+
 		ComPtr<Allocation> CreateUploadBuffer(UINT64 size) {
 			if (!m_pool) {
 				constexpr POOL_DESC poolDesc{
@@ -31,10 +31,17 @@ export {
 
 	using TextureMapInfoArray = TextureMapInfo[TextureMapType::Count];
 
-	struct ObjectData {
+	struct MeshData {
 		VertexDesc VertexDesc;
 		MeshDescriptors MeshDescriptors;
+	};
+
+	struct MaterialData {
 		Material Material;
 		TextureMapInfoArray TextureMapInfoArray;
 	};
+
+	struct ObjectData {
+		uint32_t MeshIndex, MaterialIndex;
+	};
 }
@@ -3,7 +3,9 @@ module;
 #include <format>
 #include <stacktrace>
 
+#ifdef _WIN32
 #include <Windows.h>
+#endif
 
 export module ErrorHelpers;
 
@@ -28,6 +30,8 @@ export namespace ErrorHelpers {
 		throw system_error(code, format("{}\n\n0x{:08X}", MESSAGE, static_cast<uint32_t>(code.value())));
 	}
 
+#ifdef _WIN32
 	THROW(BOOL, value, GetLastError());
 	THROW(HRESULT, SUCCEEDED(value), value);
+#endif
 }
@@ -0,0 +1,284 @@
+module;
+
+#include <algorithm>
+#include <variant>
+#include <vector>
+
+#include <DirectXMath.h>
+
+#include "PhysX.h"
+
+export module ForceFields;
+
+export import NBodyGravitation;
+
+import ErrorHelpers;
+import ThreadHelpers;
+
+using namespace DirectX;
+using namespace ErrorHelpers;
+using namespace PhysicsHelpers;
+using namespace physx;
+using namespace std;
+using namespace ThreadHelpers;
+
+export {
+	using ForceFieldMask = uint32_t;
+
+	struct SpringField {
+		PxReal PositionY, Period;
+	};
+
+	struct PointGravityField {
+		const PxRigidBody* Source;
+	};
+
+	struct DirectionalAttractorField {
+		const PxRigidActor* Target;
+		PxReal Acceleration;
+	};
+
+	struct MutualGravitationField {
+		NBodyGravitation::Parameters Parameters;
+		NBodyGravitation::Method Method = NBodyGravitation::Method::Automatic;
+	};
+
+	class ForceFieldSystem {
+	public:
+		static constexpr size_t MaxFieldCount = sizeof(ForceFieldMask) * 8, BatchSize = 1024;
+
+		ForceFieldMask Add(const SpringField& field) { return AddField(field); }
+		ForceFieldMask Add(const PointGravityField& field) { return AddField(field); }
+		ForceFieldMask Add(const DirectionalAttractorField& field) { return AddField(field); }
+		ForceFieldMask Add(const MutualGravitationField& field) { return AddField(field); }
+
+		bool IsEnabled(ForceFieldMask fields) const { return (m_enabledFields & fields) == fields; }
+
+		void SetEnabled(ForceFieldMask fields, bool value) {
+			if (value) {
+				m_enabledFields |= fields;
+			}
+			else {
+				m_enabledFields &= ~fields;
+			}
+		}
+
+		size_t GetBodyCount() const { return size(m_bodies); }
+
+		void AddBody(PxRigidBody& rigidBody, ForceFieldMask fields) {
+			if (!fields) {
+				return;
+			}
+
+			m_bodies.emplace_back(&rigidBody, fields);
+
+			const auto packetCount = (size(m_bodies) + 3) / 4;
+			for (auto pArray : { &m_x, &m_y, &m_z, &m_masses, &m_accelerationX, &m_accelerationY, &m_accelerationZ }) {
+				pArray->resize(packetCount * 4);
+			}
+			m_masks.resize(packetCount * 4);
+		}
+
+		void Clear() {
+			m_fields.clear();
+			m_enabledFields = 0;
+
+			m_bodies.clear();
+			for (auto pArray : { &m_x, &m_y, &m_z, &m_masses, &m_accelerationX, &m_accelerationY, &m_accelerationZ }) {
+				pArray->clear();
+			}
+			m_masks.clear();
+		}
+
+		void Apply() {
+			if (empty(m_bodies) || !m_enabledFields) {
+				return;
+			}
+
+			const auto fields = ResolveFields();
+
+			ParallelFor(size(m_bodies), BatchSize, [&](size_t first, size_t last) {
+				for (auto i = first; i < last; i++) {
+					const auto& [RigidBody, Fields] = m_bodies[i];
+
+					auto& mask = m_masks[i];
+					mask = Fields & m_enabledFields;
+					if (!mask || RigidBody->getActorFlags() & PxActorFlag::eDISABLE_SIMULATION) {
+						mask = 0;
+						continue;
+					}
+
+					m_masses[i] = RigidBody->getMass();
+					if (!m_masses[i]) {
+						mask = 0;
+						continue;
+					}
+
+					const auto& position = RigidBody->getGlobalPose().p;
+					m_x[i] = position.x;
+					m_y[i] = position.y;
+					m_z[i] = position.z;
+				}
+			});
+
+			ParallelFor(size(m_masks) / 4, BatchSize / 4, [&](size_t first, size_t last) {
+				for (auto i = first * 4; i < last * 4; i += 4) {
+					const auto masks = XMLoadInt4(&m_masks[i]);
+					if (XMVector4EqualInt(masks, XMVectorZero())) {
+						continue;
+					}
+
+					const auto
+						x = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&m_x[i])),
+						y = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&m_y[i])),
+						z = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&m_z[i]));
+
+					auto accelerationX = XMVectorZero(), accelerationY = XMVectorZero(), accelerationZ = XMVectorZero();
+					for (const auto& [Type, Mask, Position, Scale] : fields) {
+						const auto mask = XMVectorReplicateInt(Mask);
+						auto selected = XMVectorEqualInt(XMVectorAndInt(masks, mask), mask);
+
+						if (Type == FieldType::Spring) {
+							accelerationY = XMVectorAdd(accelerationY, XMVectorSelect(XMVectorZero(), XMVectorMultiply(XMVectorReplicate(-Scale), XMVectorSubtract(y, XMVectorReplicate(Position.y))), selected));
+							continue;
+						}
+
+						const auto
+							dx = XMVectorSubtract(XMVectorReplicate(Position.x), x),
+							dy = XMVectorSubtract(XMVectorReplicate(Position.y), y),
+							dz = XMVectorSubtract(XMVectorReplicate(Position.z), z);
+						const auto distanceSquared = XMVectorMultiplyAdd(dz, dz, XMVectorMultiplyAdd(dy, dy, XMVectorMultiply(dx, dx)));
+						selected = XMVectorAndInt(selected, XMVectorGreater(distanceSquared, XMVectorZero()));
+
+						const auto reciprocalDistance = XMVectorReciprocalSqrt(distanceSquared);
+						auto scale = XMVectorMultiply(XMVectorReplicate(Scale), reciprocalDistance);
+						if (Type == FieldType::PointGravity) {
+							scale = XMVectorMultiply(scale, XMVectorMultiply(reciprocalDistance, reciprocalDistance));
+						}
+						scale = XMVectorSelect(XMVectorZero(), scale, selected);
+
+						accelerationX = XMVectorMultiplyAdd(scale, dx, accelerationX);
+						accelerationY = XMVectorMultiplyAdd(scale, dy, accelerationY);
+						accelerationZ = XMVectorMultiplyAdd(scale, dz, accelerationZ);
+					}
+
+					XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&m_accelerationX[i]), accelerationX);
+					XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&m_accelerationY[i]), accelerationY);
+					XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&m_accelerationZ[i]), accelerationZ);
+				}
+			});
+
+			for (size_t i = 0; i < size(m_fields); i++) {
+				if (const auto pField = get_if<MutualGravitationField>(&m_fields[i]); pField != nullptr && m_enabledFields & ForceFieldMask{ 1 } << i) {
+					ApplyMutualGravitation(*pField, ForceFieldMask{ 1 } << i);
+				}
+			}
+
+			for (size_t i = 0; i < size(m_bodies); i++) {
+				if (m_masks[i]) {
+					m_bodies[i].RigidBody->addForce({ m_accelerationX[i], m_accelerationY[i], m_accelerationZ[i] }, PxForceMode::eACCELERATION);
+				}
+			}
+		}
+
+	private:
+		enum class FieldType { Spring, PointGravity, DirectionalAttractor };
+
+		struct ResolvedField {
+			FieldType Type;
+			ForceFieldMask Mask;
+			PxVec3 Position;
+			PxReal Scale;
+		};
+
+		struct Body {
+			PxRigidBody* RigidBody;
+			ForceFieldMask Fields;
+		};
+
+		vector<variant<SpringField, PointGravityField, DirectionalAttractorField, MutualGravitationField>> m_fields;
+		ForceFieldMask m_enabledFields{};
+
+		vector<Body> m_bodies;
+		vector<float> m_x, m_y, m_z, m_masses, m_accelerationX, m_accelerationY, m_accelerationZ;
+		vector<uint32_t> m_masks;
+
+		struct {
+			vector<uint32_t> Indices;
+			vector<float> X, Y, Z, Masses, AccelerationX, AccelerationY, AccelerationZ;
+			NBodyGravitation::Octree Octree;
+		} m_mutualGravitation;
+
+		ForceFieldMask AddField(const auto& field) {
+			if (size(m_fields) == MaxFieldCount) {
+				Throw<out_of_range>("Too many force fields");
+			}
+
+			const auto mask = ForceFieldMask{ 1 } << size(m_fields);
+			m_fields.emplace_back(field);
+			m_enabledFields |= mask;
+			return mask;
+		}
+
+		void ApplyMutualGravitation(const MutualGravitationField& field, ForceFieldMask mask) {
+			auto& [Indices, X, Y, Z, Masses, AccelerationX, AccelerationY, AccelerationZ, Octree] = m_mutualGravitation;
+
+			Indices.clear();
+			for (size_t i = 0; i < size(m_bodies); i++) {
+				if (m_masks[i] & mask) {
+					Indices.emplace_back(static_cast<uint32_t>(i));
+				}
+			}
+			if (size(Indices) < 2) {
+				return;
+			}
+
+			for (auto pArray : { &X, &Y, &Z, &Masses, &AccelerationX, &AccelerationY, &AccelerationZ }) {
+				pArray->resize(size(Indices));
+			}
+			ParallelFor(size(Indices), BatchSize, [&](size_t first, size_t last) {
+				for (auto i = first; i < last; i++) {
+					const auto index = Indices[i];
+					X[i] = m_x[index];
+					Y[i] = m_y[index];
+					Z[i] = m_z[index];
+					Masses[i] = m_masses[index];
+				}
+			});
+
+			NBodyGravitation::Compute({ X, Y, Z, Masses }, { AccelerationX, AccelerationY, AccelerationZ }, field.Parameters, Octree, field.Method);
+
+			ParallelFor(size(Indices), BatchSize, [&](size_t first, size_t last) {
+				for (auto i = first; i < last; i++) {
+					const auto index = Indices[i];
+					m_accelerationX[index] += AccelerationX[i];
+					m_accelerationY[index] += AccelerationY[i];
+					m_accelerationZ[index] += AccelerationZ[i];
+				}
+			});
+		}
+
+		vector<ResolvedField> ResolveFields() const {
+			vector<ResolvedField> fields;
+			fields.reserve(size(m_fields));
+			for (size_t i = 0; i < size(m_fields); i++) {
+				const auto mask = ForceFieldMask{ 1 } << i;
+				if (!(m_enabledFields & mask)) {
+					continue;
+				}
+
+				if (const auto pField = get_if<SpringField>(&m_fields[i])) {
+					const auto omega = PxTwoPi / pField->Period;
+					fields.emplace_back(FieldType::Spring, mask, PxVec3(0, pField->PositionY, 0), omega * omega);
+				}
+				else if (const auto pField = get_if<PointGravityField>(&m_fields[i])) {
+					fields.emplace_back(FieldType::PointGravity, mask, pField->Source->getGlobalPose().p, UniversalGravitation::CalculateAccelerationMagnitude(pField->Source->getMass(), 1.0f));
+				}
+				else if (const auto pField = get_if<DirectionalAttractorField>(&m_fields[i])) {
+					fields.emplace_back(FieldType::DirectionalAttractor, mask, pField->Target->getGlobalPose().p, pField->Acceleration);
+				}
+			}
+			return fields;
+		}
+	};
+}
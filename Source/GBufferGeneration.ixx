@@ -48,7 +48,7 @@ export struct GBufferGeneration {
 		uint32_t Flags{};
 	};
 
-	struct { GPUBuffer* SceneData, * Camera, * InstanceData, * ObjectData; } GPUBuffers{};
+	struct { GPUBuffer* SceneData, * Camera, * InstanceData, * ObjectData, * MeshData, * MaterialData; } GPUBuffers{};
 
 	struct {
 		Texture
@@ -99,6 +99,16 @@ export struct GBufferGeneration {
 			commandList->SetComputeRootShaderResourceView(i, GPUBuffers.ObjectData->GetNative()->GetGPUVirtualAddress());
 		}
 		i++;
+		if (GPUBuffers.MeshData) {
+			commandList.SetState(*GPUBuffers.MeshData, D3D12_RESOURCE_STATE_ALL_SHADER_RESOURCE);
+			commandList->SetComputeRootShaderResourceView(i, GPUBuffers.MeshData->GetNative()->GetGPUVirtualAddress());
+		}
+		i++;
+		if (GPUBuffers.MaterialData) {
+			commandList.SetState(*GPUBuffers.MaterialData, D3D12_RESOURCE_STATE_ALL_SHADER_RESOURCE);
+			commandList->SetComputeRootShaderResourceView(i, GPUBuffers.MaterialData->GetNative()->GetGPUVirtualAddress());
+		}
+		i++;
 		SET1(Position);
 		SET1(FlatNormal);
 		SET1(GeometricNormal);
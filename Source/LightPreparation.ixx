@@ -26,7 +26,7 @@ using namespace Microsoft::WRL;
 using namespace std;
 
 export struct LightPreparation {
-	struct { GPUBuffer* InstanceData, * ObjectData, * LightInfo; } GPUBuffers{};
+	struct { GPUBuffer* InstanceData, * ObjectData, * MeshData, * MaterialData, * LightInfo; } GPUBuffers{};
 
 	struct { Texture* LocalLightPDF; } Textures{};
 
@@ -103,6 +103,8 @@ export struct LightPreparation {
 		commandList.SetState(*m_GPUBuffers.Tasks, D3D12_RESOURCE_STATE_ALL_SHADER_RESOURCE);
 		commandList.SetState(*GPUBuffers.InstanceData, D3D12_RESOURCE_STATE_ALL_SHADER_RESOURCE);
 		commandList.SetState(*GPUBuffers.ObjectData, D3D12_RESOURCE_STATE_ALL_SHADER_RESOURCE);
+		commandList.SetState(*GPUBuffers.MeshData, D3D12_RESOURCE_STATE_ALL_SHADER_RESOURCE);
+		commandList.SetState(*GPUBuffers.MaterialData, D3D12_RESOURCE_STATE_ALL_SHADER_RESOURCE);
 		commandList.SetState(*GPUBuffers.LightInfo, D3D12_RESOURCE_STATE_ALL_SHADER_RESOURCE);
 		commandList.SetState(*Textures.LocalLightPDF, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
 
@@ -110,8 +112,10 @@ export struct LightPreparation {
 		commandList->SetComputeRootShaderResourceView(1, m_GPUBuffers.Tasks->GetNative()->GetGPUVirtualAddress());
 		commandList->SetComputeRootShaderResourceView(2, GPUBuffers.InstanceData->GetNative()->GetGPUVirtualAddress());
 		commandList->SetComputeRootShaderResourceView(3, GPUBuffers.ObjectData->GetNative()->GetGPUVirtualAddress());
-		commandList->SetComputeRootUnorderedAccessView(4, GPUBuffers.LightInfo->GetNative()->GetGPUVirtualAddress());
-		commandList->SetComputeRootDescriptorTable(5, Textures.LocalLightPDF->GetUAVDescriptor());
+		commandList->SetComputeRootShaderResourceView(4, GPUBuffers.MeshData->GetNative()->GetGPUVirtualAddress());
+		commandList->SetComputeRootShaderResourceView(5, GPUBuffers.MaterialData->GetNative()->GetGPUVirtualAddress());
+		commandList->SetComputeRootUnorderedAccessView(6, GPUBuffers.LightInfo->GetNative()->GetGPUVirtualAddress());
+		commandList->SetComputeRootDescriptorTable(7, Textures.LocalLightPDF->GetUAVDescriptor());
 
 		commandList->Dispatch((m_emissiveTriangleCount + 255) / 256, 1, 1);
 	}
@@ -1,3 +1,4 @@
+#include <print>
 #include <set>
 
 #include <Windows.h>
@@ -18,6 +19,7 @@
 
 import App;
 import ErrorHelpers;
+import NBodyGravitation;
 import SharedData;
 
 using namespace DirectX;
@@ -40,6 +42,29 @@ namespace {
 	exception_ptr g_exception;
 }
 
+namespace {
+	int RunNBodyBenchmark(size_t bodyCount) {
+		if (AttachConsole(ATTACH_PARENT_PROCESS) || AllocConsole()) {
+			FILE* file;
+			ignore = freopen_s(&file, "CONOUT$", "w", stdout);
+		}
+
+		constexpr float OpeningAngles[]{ 0.3f, 0.5f, 0.7f, 1 };
+
+		println("Bodies: {}", bodyCount);
+		for (const auto& [Method, OpeningAngle, Seconds, MeanRelativeError, MaxRelativeError] : NBodyGravitation::RunBenchmark(bodyCount, OpeningAngles)) {
+			if (Method == NBodyGravitation::Method::Exact) {
+				println("Exact: {:.3f} ms", Seconds * 1000);
+			}
+			else {
+				println("Barnes-Hut (theta = {:.1f}): {:.3f} ms, mean relative error {:.2e}, max relative error {:.2e}", OpeningAngle, Seconds * 1000, MeanRelativeError, MaxRelativeError);
+			}
+		}
+
+		return ERROR_SUCCESS;
+	}
+}
+
 extern "C" {
 	__declspec(dllexport) extern const UINT D3D12SDKVersion = D3D12_SDK_VERSION;
 	__declspec(dllexport) extern const char* D3D12SDKPath = D3D12_AGILITY_SDK_PATH;
@@ -58,6 +83,10 @@ int WINAPI wWinMain(
 	string error;
 
 	try {
+		if (__argc > 1 && !_wcsicmp(__wargv[1], L"--nbody-benchmark")) {
+			return RunNBodyBenchmark(__argc > 2 ? stoull(__wargv[2]) : 100000);
+		}
+
 		ThrowIfFailed(RoInitialize(RO_INIT_MULTITHREADED));
 
 		ignore = NvAPI_Initialize();
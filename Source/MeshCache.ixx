@@ -0,0 +1,231 @@
+module;
+
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <optional>
+#include <span>
+#include <variant>
+
+#include <Windows.h>
+#include <compressapi.h>
+
+#include <wrl.h>
+
+#pragma comment(lib, "Cabinet.lib")
+
+export module MeshCache;
+
+import ErrorHelpers;
+import MeshHelpers;
+import Model;
+
+using namespace ErrorHelpers;
+using namespace Microsoft::WRL::Wrappers;
+using namespace std;
+using namespace std::filesystem;
+
+namespace {
+	constexpr uint32_t Magic = 0x4853454d, Version = 4;
+
+	struct Header {
+		uint32_t Magic = ::Magic, Version = ::Version;
+		uint64_t KeyHash{};
+		uint32_t VertexStride = sizeof(Mesh::VertexType), IndexStride{};
+		uint64_t VertexCount{}, IndexCount{};
+		uint32_t IsCompressed{}, IsOptimized{};
+		uint64_t PayloadSize{};
+		MeshHelpers::OptimizationReport OptimizationReport{};
+		float LODError{};
+		uint32_t _{};
+
+		auto GetDecompressedPayloadSize() const { return VertexStride * VertexCount + IndexStride * IndexCount; }
+
+		bool IsValid(uint64_t keyHash) const {
+			return Magic == ::Magic && Version == ::Version
+				&& KeyHash == keyHash
+				&& VertexStride == sizeof(Mesh::VertexType)
+				&& (IndexStride == sizeof(uint16_t) || IndexStride == sizeof(uint32_t))
+				&& (IsCompressed || PayloadSize == GetDecompressedPayloadSize());
+		}
+	};
+
+	constexpr uint64_t HashKey(string_view key) {
+		uint64_t hash = 0xcbf29ce484222325;
+		for (const auto c : key) {
+			hash = (hash ^ static_cast<uint8_t>(c)) * 0x100000001b3;
+		}
+		return hash;
+	}
+}
+
+export namespace MeshCache {
+	struct Metadata {
+		float LODError{};
+		optional<MeshHelpers::OptimizationReport> OptimizationReport;
+	};
+
+	struct Info {
+		uint64_t VertexCount, IndexCount;
+		Metadata Metadata;
+	};
+
+	constexpr size_t MinCompressionSize = 256 << 10;
+
+	inline const path DirectoryPath = path(*__wargv).replace_filename(L"Cache") / L"Meshes";
+
+	path GetFilePath(string_view key) { return DirectoryPath / format("{:016X}.mesh", HashKey(key)); }
+
+	optional<Info> GetInfo(const path& filePath, string_view key) {
+		Header header;
+		ifstream file(filePath, ios::binary);
+		if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))
+			|| !header.IsValid(HashKey(key))
+			|| file_size(filePath) != sizeof(header) + header.PayloadSize) {
+			return nullopt;
+		}
+		return Info{
+			.VertexCount = header.VertexCount,
+			.IndexCount = header.IndexCount,
+			.Metadata{
+				.LODError = header.LODError,
+				.OptimizationReport = header.IsOptimized ? optional(header.OptimizationReport) : nullopt
+			}
+		};
+	}
+
+	bool IsValid(const path& filePath, string_view key) { return GetInfo(filePath, key).has_value(); }
+
+	void Save(const path& filePath, string_view key, span<const Mesh::VertexType> vertices, span<const Mesh::IndexType> indices, const Metadata& metadata = {}, bool compress = false) {
+		Header header{
+			.KeyHash = HashKey(key),
+			.IndexStride = Mesh::CanUse16BitIndices(size(vertices)) ? static_cast<uint32_t>(sizeof(uint16_t)) : static_cast<uint32_t>(sizeof(uint32_t)),
+			.VertexCount = size(vertices),
+			.IndexCount = size(indices),
+			.IsOptimized = metadata.OptimizationReport.has_value(),
+			.OptimizationReport = metadata.OptimizationReport.value_or(MeshHelpers::OptimizationReport{}),
+			.LODError = metadata.LODError
+		};
+
+		vector<std::byte> payload(header.GetDecompressedPayloadSize());
+		memcpy(data(payload), data(vertices), vertices.size_bytes());
+		if (header.IndexStride == sizeof(uint16_t)) {
+			const auto p = reinterpret_cast<uint16_t*>(data(payload) + vertices.size_bytes());
+			for (size_t i = 0; const auto index : indices) {
+				p[i++] = static_cast<uint16_t>(index);
+			}
+		}
+		else {
+			memcpy(data(payload) + vertices.size_bytes(), data(indices), indices.size_bytes());
+		}
+
+		if (compress && size(payload) >= MinCompressionSize) {
+			COMPRESSOR_HANDLE compressor;
+			ThrowIfFailed(CreateCompressor(COMPRESS_ALGORITHM_XPRESS_HUFF, nullptr, &compressor));
+			const unique_ptr<remove_pointer_t<COMPRESSOR_HANDLE>, decltype(&CloseCompressor)> scopedCompressor(compressor, CloseCompressor);
+
+			SIZE_T compressedSize;
+			if (!Compress(compressor, data(payload), size(payload), nullptr, 0, &compressedSize) && GetLastError() != ERROR_INSUFFICIENT_BUFFER) {
+				ThrowIfFailed(FALSE);
+			}
+			vector<std::byte> compressedPayload(compressedSize);
+			ThrowIfFailed(Compress(compressor, data(payload), size(payload), data(compressedPayload), size(compressedPayload), &compressedSize));
+			if (compressedSize < size(payload)) {
+				compressedPayload.resize(compressedSize);
+				payload = move(compressedPayload);
+				header.IsCompressed = TRUE;
+			}
+		}
+		header.PayloadSize = size(payload);
+
+		create_directories(filePath.parent_path());
+
+		auto temporaryFilePath = filePath;
+		temporaryFilePath += L".tmp";
+		{
+			ofstream file(temporaryFilePath, ios::binary | ios::trunc);
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			file.write(reinterpret_cast<const char*>(data(payload)), size(payload));
+			if (!file) {
+				Throw<runtime_error>(format("{}: Failed to write mesh cache", temporaryFilePath.string()));
+			}
+		}
+		rename(temporaryFilePath, filePath);
+	}
+
+	class MappedMesh {
+	public:
+		MappedMesh(const MappedMesh&) = delete;
+		MappedMesh& operator=(const MappedMesh&) = delete;
+
+		MappedMesh(const path& filePath, string_view key) noexcept(false) {
+			m_file.Attach(CreateFileW(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr));
+			ThrowIfFailed(static_cast<BOOL>(m_file.IsValid()), filePath.string());
+
+			LARGE_INTEGER fileSize;
+			ThrowIfFailed(GetFileSizeEx(m_file.Get(), &fileSize));
+
+			m_mapping.Attach(CreateFileMappingW(m_file.Get(), nullptr, PAGE_READONLY, 0, 0, nullptr));
+			ThrowIfFailed(static_cast<BOOL>(m_mapping.IsValid()), filePath.string());
+
+			m_view.reset(MapViewOfFile(m_mapping.Get(), FILE_MAP_READ, 0, 0, 0));
+			ThrowIfFailed(static_cast<BOOL>(m_view != nullptr), filePath.string());
+
+			const auto& header = *static_cast<const Header*>(m_view.get());
+			if (static_cast<uint64_t>(fileSize.QuadPart) < sizeof(header)
+				|| !header.IsValid(HashKey(key))
+				|| static_cast<uint64_t>(fileSize.QuadPart) != sizeof(header) + header.PayloadSize) {
+				Throw<runtime_error>(format("{}: Invalid mesh cache", filePath.string()));
+			}
+
+			const auto payload = static_cast<const std::byte*>(m_view.get()) + sizeof(header);
+			auto decompressedPayload = payload;
+			if (header.IsCompressed) {
+				DECOMPRESSOR_HANDLE decompressor;
+				ThrowIfFailed(CreateDecompressor(COMPRESS_ALGORITHM_XPRESS_HUFF, nullptr, &decompressor));
+				const unique_ptr<remove_pointer_t<DECOMPRESSOR_HANDLE>, decltype(&CloseDecompressor)> scopedDecompressor(decompressor, CloseDecompressor);
+
+				const auto size = header.GetDecompressedPayloadSize();
+				m_decompressedPayload = make_unique_for_overwrite<std::byte[]>(size);
+				SIZE_T decompressedSize;
+				ThrowIfFailed(Decompress(decompressor, payload, header.PayloadSize, m_decompressedPayload.get(), size, &decompressedSize));
+				if (decompressedSize != size) {
+					Throw<runtime_error>(format("{}: Invalid mesh cache", filePath.string()));
+				}
+				decompressedPayload = m_decompressedPayload.get();
+			}
+
+			m_metadata.LODError = header.LODError;
+			if (header.IsOptimized) {
+				m_metadata.OptimizationReport = header.OptimizationReport;
+			}
+
+			m_vertices = { reinterpret_cast<const Mesh::VertexType*>(decompressedPayload), header.VertexCount };
+			const auto indices = decompressedPayload + m_vertices.size_bytes();
+			if (header.IndexStride == sizeof(uint16_t)) {
+				m_indices = span(reinterpret_cast<const uint16_t*>(indices), header.IndexCount);
+			}
+			else {
+				m_indices = span(reinterpret_cast<const uint32_t*>(indices), header.IndexCount);
+			}
+		}
+
+		span<const Mesh::VertexType> GetVertices() const noexcept { return m_vertices; }
+
+		const auto& GetIndices() const noexcept { return m_indices; }
+
+		const Metadata& GetMetadata() const noexcept { return m_metadata; }
+
+	private:
+		FileHandle m_file;
+		HandleT<HandleTraits::HANDLENullTraits> m_mapping;
+		unique_ptr<const void, decltype([](const void* p) { UnmapViewOfFile(p); })> m_view;
+
+		unique_ptr<std::byte[]> m_decompressedPayload;
+
+		span<const Mesh::VertexType> m_vertices;
+		variant<span<const uint16_t>, span<const uint32_t>> m_indices;
+
+		Metadata m_metadata;
+	};
+}
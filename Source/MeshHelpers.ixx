@@ -0,0 +1,228 @@
+module;
+
+#include <algorithm>
+#include <numeric>
+#include <unordered_map>
+#include <vector>
+
+#include <DirectXCollision.h>
+
+#include "DirectXMesh.h"
+
+export module MeshHelpers;
+
+import ErrorHelpers;
+
+using namespace DirectX;
+using namespace ErrorHelpers;
+using namespace std;
+
+namespace {
+	struct Quadric {
+		double A2{}, AB{}, AC{}, AD{}, B2{}, BC{}, BD{}, C2{}, CD{}, D2{}, Weight{};
+
+		Quadric() = default;
+
+		Quadric(const XMFLOAT3& normal, float distance, double weight) :
+			A2(normal.x * normal.x * weight), AB(normal.x * normal.y * weight), AC(normal.x * normal.z * weight), AD(normal.x * distance * weight),
+			B2(normal.y * normal.y * weight), BC(normal.y * normal.z * weight), BD(normal.y * distance * weight),
+			C2(normal.z * normal.z * weight), CD(normal.z * distance * weight),
+			D2(static_cast<double>(distance) * distance * weight),
+			Weight(weight) {}
+
+		Quadric& operator+=(const Quadric& rhs) {
+			A2 += rhs.A2; AB += rhs.AB; AC += rhs.AC; AD += rhs.AD;
+			B2 += rhs.B2; BC += rhs.BC; BD += rhs.BD;
+			C2 += rhs.C2; CD += rhs.CD;
+			D2 += rhs.D2;
+			Weight += rhs.Weight;
+			return *this;
+		}
+
+		Quadric operator+(const Quadric& rhs) const { return Quadric(*this) += rhs; }
+
+		double GetError(const XMFLOAT3& position) const {
+			const double x = position.x, y = position.y, z = position.z;
+			const auto error = A2 * x * x + B2 * y * y + C2 * z * z
+				+ 2 * (AB * x * y + AC * x * z + BC * y * z + AD * x + BD * y + CD * z)
+				+ D2;
+			return Weight > 0 ? sqrt(max(0.0, error) / Weight) : 0;
+		}
+	};
+
+	XMVECTOR GetTriangleNormal(FXMVECTOR p0, FXMVECTOR p1, FXMVECTOR p2) { return XMVector3Cross(p1 - p0, p2 - p0); }
+}
+
+export namespace MeshHelpers {
+	struct VertexCacheStatistics { float ACMR, ATVR; };
+
+	struct OptimizationReport { VertexCacheStatistics Before, After; };
+
+	VertexCacheStatistics ComputeVertexCacheStatistics(const vector<uint32_t>& indices, size_t vertexCount) {
+		VertexCacheStatistics statistics;
+		ComputeVertexCacheMissRate(data(indices), size(indices) / 3, vertexCount, OPTFACES_LRU_DEFAULT, statistics.ACMR, statistics.ATVR);
+		return statistics;
+	}
+
+	template <typename T>
+	OptimizationReport Optimize(vector<T>& vertices, vector<uint32_t>& indices) {
+		const auto faceCount = size(indices) / 3, vertexCount = size(vertices);
+
+		OptimizationReport report;
+		report.Before = ComputeVertexCacheStatistics(indices, vertexCount);
+
+		vector<uint32_t> faceRemap(faceCount);
+		ThrowIfFailed(OptimizeFacesLRU(data(indices), faceCount, data(faceRemap)));
+		ThrowIfFailed(ReorderIB(data(indices), faceCount, data(faceRemap)));
+
+		vector<uint32_t> vertexRemap(vertexCount);
+		size_t trailingUnusedCount;
+		ThrowIfFailed(OptimizeVertices(data(indices), faceCount, vertexCount, data(vertexRemap), &trailingUnusedCount));
+		ThrowIfFailed(FinalizeIB(data(indices), faceCount, data(vertexRemap), vertexCount));
+		ThrowIfFailed(FinalizeVB(data(vertices), sizeof(T), vertexCount, data(vertexRemap)));
+		vertices.resize(vertexCount - trailingUnusedCount);
+
+		report.After = ComputeVertexCacheStatistics(indices, size(vertices));
+
+		return report;
+	}
+
+	template <typename T>
+	float Simplify(vector<T>& vertices, vector<uint32_t>& indices, size_t targetIndexCount, float maxError) {
+		const auto vertexCount = size(vertices);
+		if (!vertexCount) {
+			return 0;
+		}
+
+		BoundingSphere boundingSphere;
+		BoundingSphere::CreateFromPoints(boundingSphere, vertexCount, &vertices[0].Position, sizeof(T));
+		const auto scale = boundingSphere.Radius > 0 ? boundingSphere.Radius : 1;
+
+		vector<Quadric> quadrics(vertexCount);
+		unordered_map<uint64_t, uint32_t> edgeCounts;
+		for (size_t i = 0; i + 2 < size(indices); i += 3) {
+			const uint32_t triangle[]{ indices[i], indices[i + 1], indices[i + 2] };
+			const auto normal = GetTriangleNormal(XMLoadFloat3(&vertices[triangle[0]].Position), XMLoadFloat3(&vertices[triangle[1]].Position), XMLoadFloat3(&vertices[triangle[2]].Position));
+			if (const auto length = XMVectorGetX(XMVector3Length(normal)); length > 0) {
+				XMFLOAT3 unitNormal;
+				XMStoreFloat3(&unitNormal, normal / length);
+				const Quadric quadric(unitNormal, -XMVectorGetX(XMVector3Dot(normal / length, XMLoadFloat3(&vertices[triangle[0]].Position))), length * 0.5);
+				for (const auto index : triangle) {
+					quadrics[index] += quadric;
+				}
+			}
+			for (size_t j = 0; j < 3; j++) {
+				const auto a = triangle[j], b = triangle[(j + 1) % 3];
+				edgeCounts[static_cast<uint64_t>(min(a, b)) << 32 | max(a, b)]++;
+			}
+		}
+
+		vector<bool> isLocked(vertexCount);
+		for (const auto& [edge, count] : edgeCounts) {
+			if (count == 1) {
+				isLocked[edge >> 32] = isLocked[edge & ~0u] = true;
+			}
+		}
+
+		vector<uint32_t> remap(vertexCount);
+		iota(begin(remap), end(remap), 0);
+
+		const auto maxDistance = static_cast<double>(maxError) * scale;
+		double error = 0;
+		while (size(indices) > targetIndexCount) {
+			struct Collapse {
+				uint32_t From, To;
+				double Error;
+			};
+			vector<Collapse> collapses;
+			vector<vector<uint32_t>> vertexTriangles(vertexCount);
+			for (uint32_t i = 0; i < size(indices) / 3; i++) {
+				for (size_t j = 0; j < 3; j++) {
+					const auto a = indices[i * 3 + j], b = indices[i * 3 + (j + 1) % 3];
+					vertexTriangles[a].emplace_back(i);
+					for (const auto [from, to] : { pair{ a, b }, pair{ b, a } }) {
+						if (!isLocked[from]) {
+							collapses.emplace_back(from, to, (quadrics[from] + quadrics[to]).GetError(vertices[to].Position));
+						}
+					}
+				}
+			}
+			ranges::sort(collapses, {}, &Collapse::Error);
+
+			auto triangleCount = size(indices) / 3;
+			vector<bool> isTouched(vertexCount);
+			bool isCollapsed = false;
+			for (const auto& collapse : collapses) {
+				if (triangleCount * 3 <= targetIndexCount || collapse.Error > maxDistance) {
+					break;
+				}
+				if (isTouched[collapse.From] || isTouched[collapse.To]) {
+					continue;
+				}
+
+				bool isValid = true;
+				size_t removedTriangleCount = 0;
+				for (const auto i : vertexTriangles[collapse.From]) {
+					uint32_t triangle[]{ remap[indices[i * 3]], remap[indices[i * 3 + 1]], remap[indices[i * 3 + 2]] };
+					if (triangle[0] == triangle[1] || triangle[1] == triangle[2] || triangle[2] == triangle[0]) {
+						continue;
+					}
+					if (ranges::find(triangle, collapse.To) != end(triangle)) {
+						removedTriangleCount++;
+						continue;
+					}
+					const auto GetNormal = [&] {
+						return GetTriangleNormal(XMLoadFloat3(&vertices[triangle[0]].Position), XMLoadFloat3(&vertices[triangle[1]].Position), XMLoadFloat3(&vertices[triangle[2]].Position));
+					};
+					const auto normal = GetNormal();
+					ranges::replace(triangle, collapse.From, collapse.To);
+					if (XMVectorGetX(XMVector3Dot(normal, GetNormal())) <= 0) {
+						isValid = false;
+						break;
+					}
+				}
+				if (!isValid) {
+					continue;
+				}
+
+				for (const auto i : vertexTriangles[collapse.From]) {
+					for (size_t j = 0; j < 3; j++) {
+						isTouched[remap[indices[i * 3 + j]]] = true;
+					}
+				}
+				remap[collapse.From] = collapse.To;
+				quadrics[collapse.To] += quadrics[collapse.From];
+				triangleCount -= removedTriangleCount;
+				error = max(error, collapse.Error);
+				isCollapsed = true;
+			}
+			if (!isCollapsed) {
+				break;
+			}
+
+			vector<uint32_t> newIndices;
+			newIndices.reserve(triangleCount * 3);
+			for (size_t i = 0; i + 2 < size(indices); i += 3) {
+				const auto a = remap[indices[i]], b = remap[indices[i + 1]], c = remap[indices[i + 2]];
+				if (a != b && b != c && c != a) {
+					newIndices.insert(cend(newIndices), { a, b, c });
+				}
+			}
+			indices = move(newIndices);
+		}
+
+		vector<uint32_t> newVertexIndices(vertexCount, ~0u);
+		vector<T> newVertices;
+		for (auto& index : indices) {
+			auto& newIndex = newVertexIndices[index];
+			if (newIndex == ~0u) {
+				newIndex = static_cast<uint32_t>(size(newVertices));
+				newVertices.emplace_back(vertices[index]);
+			}
+			index = newIndex;
+		}
+		vertices = move(newVertices);
+
+		return static_cast<float>(error / scale);
+	}
+}
@@ -0,0 +1,162 @@
+module;
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <span>
+#include <unordered_map>
+
+#include <intrin.h>
+
+export module MeshRegistry;
+
+import Model;
+
+using namespace std;
+
+namespace {
+	struct Hash128 {
+		uint64_t Low, High;
+
+		bool operator==(const Hash128&) const = default;
+	};
+
+	constexpr uint64_t Mix(uint64_t value) {
+		value ^= value >> 33;
+		value *= 0xff51afd7ed558ccd;
+		value ^= value >> 33;
+		value *= 0xc4ceb9fe1a85ec53;
+		value ^= value >> 33;
+		return value;
+	}
+
+	Hash128 HashContent(span<const std::byte> data, uint64_t seed) {
+		constexpr size_t StripeSize = sizeof(__m128i) * 4;
+
+		const __m128i secrets[]{
+			_mm_set_epi64x(0xbe4ba423396cfeb8, 0x1cad21f72c81017c),
+			_mm_set_epi64x(0xdb979083e96dd4de, 0x1f67b3b7a4a44072),
+			_mm_set_epi64x(0x78e5c0cc4ee679cb, 0x2172ffcc7dd05a82),
+			_mm_set_epi64x(0x8e2443f7744608b8, 0x4c263a81e69035e0)
+		};
+		__m128i accumulators[]{
+			_mm_set_epi64x(0xc2b2ae3d27d4eb4f, 0x9e3779b185ebca87 ^ seed),
+			_mm_set_epi64x(0x165667b19e3779f9, 0x85ebca77c2b2ae63),
+			_mm_set_epi64x(0x27d4eb2f165667c5, 0x61c8864e7a143579),
+			_mm_set_epi64x(0x9e3779b97f4a7c15, 0xbf58476d1ce4e5b9 ^ seed)
+		};
+
+		const auto stripeCount = size(data) / StripeSize;
+		const auto p = reinterpret_cast<const __m128i*>(::data(data));
+		for (size_t i = 0; i < stripeCount; i++) {
+			for (size_t j = 0; j < size(accumulators); j++) {
+				const auto value = _mm_loadu_si128(p + i * size(accumulators) + j);
+				const auto key = _mm_xor_si128(value, secrets[j]);
+				const auto product = _mm_mul_epu32(key, _mm_shuffle_epi32(key, _MM_SHUFFLE(0, 3, 0, 1)));
+				accumulators[j] = _mm_add_epi64(_mm_add_epi64(accumulators[j], _mm_shuffle_epi32(value, _MM_SHUFFLE(1, 0, 3, 2))), product);
+			}
+		}
+
+		alignas(__m128i) uint64_t lanes[size(accumulators) * 2];
+		for (size_t i = 0; i < size(accumulators); i++) {
+			_mm_store_si128(reinterpret_cast<__m128i*>(lanes) + i, accumulators[i]);
+		}
+
+		uint64_t tail[2]{ seed, size(data) };
+		for (size_t i = stripeCount * StripeSize; i < size(data); i++) {
+			tail[i & 1] = (tail[i & 1] ^ static_cast<uint8_t>(data[i])) * 0x100000001b3;
+		}
+
+		Hash128 hash{ Mix(tail[0] ^ size(data)), Mix(tail[1] + seed) };
+		for (size_t i = 0; i < size(lanes); i++) {
+			hash.Low = Mix(hash.Low ^ lanes[i]) + hash.High;
+			hash.High = Mix(hash.High + lanes[size(lanes) - 1 - i]) ^ hash.Low;
+		}
+		return hash;
+	}
+}
+
+export class MeshRegistry {
+public:
+	struct Statistics {
+		size_t RegisteredMeshCount, UniqueMeshCount;
+		uint64_t DeduplicatedByteSize;
+	};
+
+	template <typename T>
+	shared_ptr<Mesh> Register(
+		const shared_ptr<const void>& source,
+		span<const Mesh::VertexType> vertices, span<const T> indices,
+		const Mesh::CreationOptions& options,
+		const function<shared_ptr<Mesh>()>& create
+	) {
+		const auto vertexBytes = as_bytes(vertices), indexBytes = as_bytes(indices);
+
+		const Key key{
+			.VertexCount = size(vertices),
+			.IndexCount = size(indices),
+			.IndexStride = sizeof(T),
+			.Optimize = options.Optimize,
+			.QuantizePositions = options.QuantizePositions,
+			.VertexHash = HashContent(vertexBytes, 0),
+			.IndexHash = HashContent(indexBytes, size(vertices))
+		};
+
+		m_statistics.RegisteredMeshCount++;
+
+		const auto IsEqual = [](span<const std::byte> a, span<const std::byte> b) { return size(a) == size(b) && !memcmp(data(a), data(b), size(b)); };
+
+		for (auto [pEntry, pEnd] = m_meshes.equal_range(key); pEntry != pEnd;) {
+			const auto& entry = pEntry->second;
+			auto mesh = entry.Mesh.lock();
+			if (!mesh) {
+				pEntry = m_meshes.erase(pEntry);
+				continue;
+			}
+			if (entry.Source.expired() || (IsEqual(entry.Vertices, vertexBytes) && IsEqual(entry.Indices, indexBytes))) {
+				m_statistics.DeduplicatedByteSize += vertices.size_bytes() + indices.size_bytes();
+				return mesh;
+			}
+			++pEntry;
+		}
+
+		if (size(m_meshes) >= m_sweepSize) {
+			erase_if(m_meshes, [](const auto& entry) { return entry.second.Mesh.expired(); });
+			m_sweepSize = max(size(m_meshes) * 2, MinSweepSize);
+		}
+
+		auto mesh = create();
+		m_meshes.emplace(key, Entry{ mesh, source, vertexBytes, indexBytes });
+		m_statistics.UniqueMeshCount++;
+		return mesh;
+	}
+
+	const Statistics& GetStatistics() const noexcept { return m_statistics; }
+
+private:
+	struct Key {
+		size_t VertexCount, IndexCount, IndexStride;
+		bool Optimize, QuantizePositions;
+		Hash128 VertexHash, IndexHash;
+
+		bool operator==(const Key&) const = default;
+	};
+
+	struct KeyHasher {
+		size_t operator()(const Key& key) const noexcept { return key.VertexHash.Low ^ (key.IndexHash.Low * 0x9e3779b97f4a7c15); }
+	};
+
+	struct Entry {
+		weak_ptr<::Mesh> Mesh;
+		weak_ptr<const void> Source;
+		span<const std::byte> Vertices, Indices;
+	};
+
+	static constexpr size_t MinSweepSize = 64;
+
+	unordered_multimap<Key, Entry, KeyHasher> m_meshes;
+	size_t m_sweepSize = MinSweepSize;
+
+	Statistics m_statistics{};
+};
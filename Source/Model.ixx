@@ -1,10 +1,15 @@
 module;
 
+#include <algorithm>
 #include <memory>
+#include <optional>
 #include <span>
+#include <vector>
 
 #include <d3d12.h>
 
+#include <DirectXCollision.h>
+
 #include "eventpp/callbacklist.h"
 
 export module Model;
@@ -12,6 +17,7 @@ export module Model;
 import CommandList;
 import DeviceContext;
 import GPUBuffer;
+import MeshHelpers;
 import Vertex;
 
 using namespace DirectX;
@@ -22,36 +28,94 @@ export struct Mesh {
 	string Name;
 
 	using VertexType = VertexPositionNormalTangentTexture;
-	using IndexType = uint16_t;
+	using QuantizedVertexType = QuantizedVertexPositionNormalTangentTexture;
+	using IndexType = uint32_t;
 	shared_ptr<GPUBuffer> Vertices;
 	shared_ptr<GPUBuffer> Indices;
+	DXGI_FORMAT PositionFormat = DXGI_FORMAT_R32G32B32_FLOAT, IndexFormat = DXGI_FORMAT_UNKNOWN;
+	XMFLOAT3 PositionBias{};
+	float PositionScale = 1;
+
+	optional<MeshHelpers::OptimizationReport> OptimizationReport;
 
 	using DestroyEvent = CallbackList<void(Mesh*)>;
 	DestroyEvent OnDestroyed;
 
-	static constexpr VertexDesc GetVertexDesc() {
-		return {
-			.Stride = sizeof(VertexType),
-			.AttributeOffsets{
-				.Normal = offsetof(VertexType, Normal),
-				.Tangent = offsetof(VertexType, Tangent),
-				.TextureCoordinates{ offsetof(VertexType, TextureCoordinates[0]) }
-			}
+	struct CreationOptions { bool Optimize, QuantizePositions; };
+
+	VertexDesc GetVertexDesc() const {
+		const auto GetDesc = [&]<typename T>() -> VertexDesc {
+			return {
+				.Stride = sizeof(T),
+				.PositionFormat = static_cast<uint32_t>(PositionFormat),
+				.AttributeOffsets{
+					.Normal = offsetof(T, Normal),
+					.Tangent = offsetof(T, Tangent),
+					.TextureCoordinates{ offsetof(T, TextureCoordinates[0]) }
+				}
+			};
 		};
+		return PositionFormat == DXGI_FORMAT_R16G16B16A16_SNORM ? GetDesc.operator()<QuantizedVertexType>() : GetDesc.operator()<VertexType>();
 	}
 
 	~Mesh() { OnDestroyed(this); }
 
-	static auto Create(const vector<VertexType>& vertices, const vector<IndexType>& indices, const DeviceContext& deviceContext, CommandList& commandList) {
-		const auto CreateBuffer = [&]<typename T>(auto & buffer, const vector<T> &data, DXGI_FORMAT format) {
-			buffer = GPUBuffer::CreateDefault<T>(deviceContext, size(data), format);
+	static constexpr bool CanUse16BitIndices(size_t vertexCount) { return vertexCount <= numeric_limits<uint16_t>::max() + size_t(1); }
+
+	template <typename T> requires same_as<T, uint16_t> || same_as<T, uint32_t>
+	static shared_ptr<Mesh> Create(span<const VertexType> vertices, span<const T> indices, const DeviceContext& deviceContext, CommandList& commandList, const CreationOptions& options = {}) {
+		if (options.Optimize) {
+			vector newVertices(cbegin(vertices), cend(vertices));
+			vector<uint32_t> newIndices(cbegin(indices), cend(indices));
+			const auto report = MeshHelpers::Optimize(newVertices, newIndices);
+			const auto mesh = Create(span<const VertexType>(newVertices), span<const uint32_t>(newIndices), deviceContext, commandList, { .QuantizePositions = options.QuantizePositions });
+			mesh->OptimizationReport = report;
+			return mesh;
+		}
+
+		if constexpr (same_as<T, uint32_t>) {
+			if (CanUse16BitIndices(size(vertices))) {
+				vector<uint16_t> newIndices;
+				newIndices.reserve(size(indices));
+				for (const auto index : indices) {
+					newIndices.emplace_back(static_cast<uint16_t>(index));
+				}
+				return Create(vertices, span<const uint16_t>(newIndices), deviceContext, commandList, options);
+			}
+		}
+
+		const auto CreateBuffer = [&]<typename U>(auto & buffer, span<const U> data, DXGI_FORMAT format) {
+			buffer = GPUBuffer::CreateDefault<U>(deviceContext, size(data), format);
 			buffer->CreateSRV(format == DXGI_FORMAT_UNKNOWN ? BufferSRVType::Raw : BufferSRVType::Typed);
 			commandList.Copy(*buffer, data);
 			commandList.SetState(*buffer, D3D12_RESOURCE_STATE_ALL_SHADER_RESOURCE);
 		};
 		const auto mesh = make_shared<Mesh>();
-		CreateBuffer(mesh->Vertices, vertices, DXGI_FORMAT_UNKNOWN);
-		CreateBuffer(mesh->Indices, indices, DXGI_FORMAT_R16_UINT);
+		mesh->IndexFormat = same_as<T, uint16_t> ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+		if (options.QuantizePositions && !empty(vertices)) {
+			BoundingBox boundingBox;
+			BoundingBox::CreateFromPoints(boundingBox, size(vertices), &vertices[0].Position, sizeof(VertexType));
+			const auto scale = max({ boundingBox.Extents.x, boundingBox.Extents.y, boundingBox.Extents.z });
+			mesh->PositionFormat = DXGI_FORMAT_R16G16B16A16_SNORM;
+			mesh->PositionBias = boundingBox.Center;
+			mesh->PositionScale = scale > 0 ? scale : 1;
+
+			vector<QuantizedVertexType> newVertices;
+			newVertices.reserve(size(vertices));
+			for (const auto& vertex : vertices) {
+				auto& newVertex = newVertices.emplace_back(QuantizedVertexType{
+					.Normal = vertex.Normal,
+					.Tangent = vertex.Tangent,
+					.TextureCoordinates{ vertex.TextureCoordinates[0], vertex.TextureCoordinates[1] }
+					});
+				newVertex.StorePosition(vertex.Position, mesh->PositionBias, mesh->PositionScale);
+			}
+			CreateBuffer(mesh->Vertices, span<const QuantizedVertexType>(newVertices), DXGI_FORMAT_UNKNOWN);
+		}
+		else {
+			CreateBuffer(mesh->Vertices, vertices, DXGI_FORMAT_UNKNOWN);
+		}
+		CreateBuffer(mesh->Indices, indices, mesh->IndexFormat);
 		return mesh;
 	}
 };
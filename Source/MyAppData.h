@@ -12,6 +12,8 @@
 
 #include "directxtk12/PostProcess.h"
 
+#include "PhysX.h"
+
 import Denoiser;
 import DisplayHelpers;
 import RTXGI;
@@ -110,6 +112,14 @@ NLOHMANN_JSON_SERIALIZE_ENUM(
 	}
 );
 
+NLOHMANN_JSON_SERIALIZE_ENUM(
+	PhysX::VisualDebuggerDesc::TransportType,
+	{
+		{ PhysX::VisualDebuggerDesc::TransportType::Socket, "Socket" },
+		{ PhysX::VisualDebuggerDesc::TransportType::File, "File" }
+	}
+);
+
 namespace DirectX {
 	NLOHMANN_JSON_SERIALIZE_ENUM(
 		ToneMapPostProcess::Operator,
@@ -179,6 +189,13 @@ public:
 				FRIEND_JSON_CONVERSION_FUNCTIONS(Camera, IsJitterEnabled, HorizontalFieldOfView);
 			} Camera;
 
+			struct TextureStreaming {
+				static constexpr uint32_t MinBudget = 64, MaxBudget = 16384;
+				uint32_t Budget = 2048;
+
+				FRIEND_JSON_CONVERSION_FUNCTIONS(TextureStreaming, Budget);
+			} TextureStreaming;
+
 			struct Raytracing {
 				bool IsRussianRouletteEnabled = true;
 
@@ -335,13 +352,15 @@ public:
 				FRIEND_JSON_CONVERSION_FUNCTIONS(PostProcessing, SuperResolution, Denoising, IsDLSSFrameGenerationEnabled, NIS, Bloom, ToneMapping);
 			} PostProcessing;
 
-			FRIEND_JSON_CONVERSION_FUNCTIONS(Graphics, WindowMode, Resolution, IsHDREnabled, IsVSyncEnabled, ReflexMode, Camera, Raytracing, PostProcessing);
+			FRIEND_JSON_CONVERSION_FUNCTIONS(Graphics, WindowMode, Resolution, IsHDREnabled, IsVSyncEnabled, ReflexMode, Camera, TextureStreaming, Raytracing, PostProcessing);
 
 			void Check() override {
 				using namespace std;
 
 				Camera.HorizontalFieldOfView = clamp(Camera.HorizontalFieldOfView, Camera.MinHorizontalFieldOfView, Camera.MaxHorizontalFieldOfView);
 
+				TextureStreaming.Budget = clamp(TextureStreaming.Budget, TextureStreaming.MinBudget, TextureStreaming.MaxBudget);
+
 				{
 					Raytracing.Bounces = min(Raytracing.Bounces, Raytracing.MaxBounces);
 					Raytracing.SamplesPerPixel = clamp(Raytracing.SamplesPerPixel, 1u, Raytracing.MaxSamplesPerPixel);
@@ -413,6 +432,39 @@ public:
 			}
 		} Controls;
 
+		inline static struct Physics : Data<Physics> {
+			inline static const std::filesystem::path FilePath = DirectoryPath / L"Physics.json";
+
+			struct VisualDebugger {
+				bool IsEnabled{};
+
+				PhysX::VisualDebuggerDesc::TransportType Transport = PhysX::VisualDebuggerDesc::TransportType::Socket;
+
+				std::string Host = "localhost";
+
+				static constexpr int MinPort = 1, MaxPort = 65535;
+				int Port = 5425;
+
+				std::string CaptureFilePath = "PhysX.pxd2";
+
+				struct Instrumentation {
+					bool IsDebugEnabled = true, IsProfileEnabled = true, IsMemoryEnabled = true;
+
+					FRIEND_JSON_CONVERSION_FUNCTIONS(Instrumentation, IsDebugEnabled, IsProfileEnabled, IsMemoryEnabled);
+				} Instrumentation;
+
+				FRIEND_JSON_CONVERSION_FUNCTIONS(VisualDebugger, IsEnabled, Transport, Host, Port, CaptureFilePath, Instrumentation);
+			} VisualDebugger;
+
+			FRIEND_JSON_CONVERSION_FUNCTIONS(Physics, VisualDebugger);
+
+			void Check() override {
+				using namespace std;
+
+				VisualDebugger.Port = clamp(VisualDebugger.Port, VisualDebugger.MinPort, VisualDebugger.MaxPort);
+			}
+		} Physics;
+
 		static auto Load() {
 			auto ret = false;
 			if (Graphics.Load()) {
@@ -427,6 +479,10 @@ public:
 				Controls.Check();
 				ret &= true;
 			}
+			if (Physics.Load()) {
+				Physics.Check();
+				ret &= true;
+			}
 			return ret;
 		}
 
@@ -435,6 +491,7 @@ public:
 			ret &= Graphics.Save();
 			ret &= UI.Save();
 			ret &= Controls.Save();
+			ret &= Physics.Save();
 			return ret;
 		}
 
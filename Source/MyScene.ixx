@@ -1,32 +1,24 @@
 module;
 
+#include <atomic>
 #include <filesystem>
-#include <ranges>
 
 #include "directxtk12/GamePad.h"
-#include "directxtk12/GeometricPrimitive.h"
 #include "directxtk12/Keyboard.h"
 #include "directxtk12/Mouse.h"
 #include "directxtk12/SimpleMath.h"
 
-#include "DirectXMesh.h"
-
 #include "PhysX.h"
 
 export module MyScene;
 
 export import Scene;
 
-import ErrorHelpers;
-import Material;
-import Model;
-import Random;
+import MySimulation;
 import Texture;
 
 using namespace DirectX;
 using namespace DirectX::SimpleMath;
-using namespace ErrorHelpers;
-using namespace PhysicsHelpers;
 using namespace physx;
 using namespace std;
 using namespace std::filesystem;
@@ -34,58 +26,11 @@ using namespace std::filesystem;
 using GamepadButtonState = GamePad::ButtonStateTracker::ButtonState;
 using Key = Keyboard::Keys;
 
-#define MAKE_NAME(name) static constexpr LPCSTR name = #name;
-
-struct ObjectNames {
-	MAKE_NAME(AlienMetal);
-	MAKE_NAME(Earth);
-	MAKE_NAME(HarmonicOscillator);
-	MAKE_NAME(Moon);
-	MAKE_NAME(Sphere);
-	MAKE_NAME(Star);
-};
-
-struct Spring { static constexpr PxReal PositionY = 0.5f, Period = 3; };
-
 export {
 	struct MySceneDesc : SceneDesc {
 		MySceneDesc() {
-			{
-				GeometricPrimitive::VertexCollection vertices;
-				GeometricPrimitive::IndexCollection indices;
-				GeometricPrimitive::CreateGeoSphere(vertices, indices, 1, 6);
-				ranges::reverse(indices);
-
-				const auto vertexCount = size(vertices);
-				vector<XMFLOAT3> positions, normals, tangents(vertexCount);
-				vector<XMFLOAT2> textureCoordinates;
-				positions.reserve(vertexCount);
-				normals.reserve(vertexCount);
-				textureCoordinates.reserve(vertexCount);
-				for (const auto& vertex : vertices) {
-					positions.emplace_back(vertex.position);
-					normals.emplace_back(vertex.normal);
-					textureCoordinates.emplace_back(vertex.textureCoordinate);
-				}
-				ThrowIfFailed(ComputeTangentFrame(
-					data(indices), size(indices) / 3,
-					data(positions), data(normals), data(textureCoordinates), vertexCount,
-					data(tangents), nullptr
-				));
-
-				auto newVertices = make_shared<vector<Mesh::VertexType>>();
-				newVertices->reserve(vertexCount);
-				for (const auto i : views::iota(static_cast<size_t>(0), vertexCount)) {
-					Mesh::VertexType vertex;
-					vertex.Position = positions[i];
-					vertex.StoreNormal(normals[i]);
-					vertex.StoreTangent(tangents[i]);
-					vertex.StoreTextureCoordinate(textureCoordinates[i], 0);
-					newVertices->emplace_back(vertex);
-				}
-
-				Meshes[ObjectNames::Sphere] = { newVertices, make_shared<vector<Mesh::IndexType>>(indices) };
-			}
+			AddGeoSphere(ObjectNames::Sphere, 1, 6, { .Optimize = true, .QuantizePositions = true });
+			GenerateLODs(ObjectNames::Sphere, 3);
 
 			Camera.Position.z = -15;
 
@@ -94,211 +39,36 @@ export {
 			EnvironmentLight.Rotation = Quaternion::CreateFromYawPitchRoll(XM_PI, 0, 0);
 			EnvironmentLight.Texture = directoryPath / L"141_hdrmaps_com_free.exr";
 
-			PhysX = make_shared<::PhysX>(8);
+			MySimulationDesc simulation;
 
-			const auto& material = *PhysX->GetPhysics().createMaterial(0.5f, 0.5f, 0.6f);
+			PhysX = simulation.PhysX;
+			RigidActors = simulation.RigidActors;
 
-			const auto AddRenderObject = [&](RenderObjectDesc& renderObject, const auto& transform, const PxSphereGeometry& geometry) -> decltype(auto) {
-				renderObject.MeshURI = ObjectNames::Sphere;
+			RenderObjects.reserve(size(simulation.Objects));
+			for (auto& [Name, Shape, Material] : simulation.Objects) {
+				RenderObjectDesc renderObject;
 
-				auto& rigidDynamic = *PhysX->GetPhysics().createRigidDynamic(PxTransform(transform));
-				PxRigidBodyExt::updateMassAndInertia(rigidDynamic, 1);
-				rigidDynamic.setAngularDamping(0);
-				PhysX->GetScene().addActor(rigidDynamic);
-
-				renderObject.Shape = PxRigidActorExt::createExclusiveShape(rigidDynamic, geometry, material);
-
-				RenderObjects.emplace_back(renderObject);
-
-				return rigidDynamic;
-			};
-
-			{
-				const struct {
-					LPCSTR Name;
-					PxVec3 Position;
-					Material Material;
-				} objects[]{
-					{
-						.Name = ObjectNames::AlienMetal,
-						.Position{ -2, 0.5f, 0 },
-						.Material{
-							.BaseColor = Vector4::One,
-							.Metallic = 1,
-							.Roughness = 1
-						}
-					},
-					{
-						.Position{ 0, 0.5f, 0 },
-						.Material{
-							.BaseColor{ 1, 1, 1, 1 },
-							.Roughness = 0,
-							.Transmission = 1
-						}
-					},
-					{
-						.Position{ 0, 2, 0 },
-						.Material{
-							.BaseColor{ 1, 1, 1, 1 },
-							.Roughness = 0.5f,
-							.Transmission = 1
-						}
-					},
-					{
-						.Position{ 2, 0.5f, 0 },
-						.Material{
-							.BaseColor{ 0.7f, 0.6f, 0.5f, 1 },
-							.Metallic = 1,
-							.Roughness = 0.3f
-						}
-					}
-				};
-				for (const auto& [Name, Position, Material] : objects) {
-					RenderObjectDesc renderObject;
-
-					renderObject.Material = Material;
-
-					if (auto& textures = renderObject.Textures; Name == ObjectNames::AlienMetal) {
-						textures[to_underlying(TextureMapType::BaseColor)] = directoryPath / L"Alien-Metal_Albedo.png";
-						textures[to_underlying(TextureMapType::Metallic)] = directoryPath / L"Alien-Metal_Metallic.png";
-						textures[to_underlying(TextureMapType::Roughness)] = directoryPath / L"Alien-Metal_Roughness.png";
-						textures[to_underlying(TextureMapType::Normal)] = directoryPath / L"Alien-Metal_Normal.png";
-					}
-
-					AddRenderObject(renderObject, Position, PxSphereGeometry(0.5f));
+				renderObject.Name = move(Name);
+				renderObject.MeshURI = ObjectNames::Sphere;
+				renderObject.Material = Material;
+				renderObject.Shape = Shape;
+
+				if (auto& textures = renderObject.Textures; renderObject.Name == ObjectNames::AlienMetal) {
+					textures[to_underlying(TextureMapType::BaseColor)] = directoryPath / L"Alien-Metal_Albedo.png";
+					textures[to_underlying(TextureMapType::Metallic)] = directoryPath / L"Alien-Metal_Metallic.png";
+					textures[to_underlying(TextureMapType::Roughness)] = directoryPath / L"Alien-Metal_Roughness.png";
+					textures[to_underlying(TextureMapType::Normal)] = directoryPath / L"Alien-Metal_Normal.png";
 				}
-
-				for (Random random; const auto i : views::iota(-10, 11)) {
-					for (const auto j : views::iota(-10, 11)) {
-						constexpr auto A = 0.5f;
-						const auto omega = PxTwoPi / Spring::Period;
-
-						PxVec3 position;
-						position.x = static_cast<float>(i) + 0.7f * random.Float();
-						position.y = Spring::PositionY + SimpleHarmonicMotion::Spring::CalculateDisplacement(A, omega, 0.0f, position.x);
-						position.z = static_cast<float>(j) - 0.7f * random.Float();
-
-						auto isOverlapping = false;
-						for (const auto& [_, Position, Material] : objects) {
-							if ((position - Position).magnitude() < 1) {
-								isOverlapping = true;
-								break;
-							}
-						}
-						if (isOverlapping) {
-							continue;
-						}
-
-						RenderObjectDesc renderObject;
-
-						renderObject.Name = ObjectNames::HarmonicOscillator;
-
-						const auto RandomFloat4 = [&](float min) {
-							const auto value = random.Float3(min);
-							return Vector4(value.x, value.y, value.z, 1);
-						};
-						if (const auto randomValue = random.Float();
-							randomValue < 0.3f) {
-							renderObject.Material = { .BaseColor = RandomFloat4(0.1f) };
-						}
-						else if (randomValue < 0.6f) {
-							renderObject.Material = {
-								.BaseColor = RandomFloat4(0.1f),
-								.Metallic = 1,
-								.Roughness = random.Float(0, 0.5f)
-							};
-						}
-						else if (randomValue < 0.8f) {
-							renderObject.Material = {
-								.BaseColor = RandomFloat4(0.1f),
-								.Roughness = random.Float(0, 0.5f),
-								.Transmission = 1
-							};
-						}
-						else {
-							renderObject.Material = {
-								.BaseColor = RandomFloat4(0.1f),
-								.EmissiveStrength = random.Float(1, 10),
-								.EmissiveColor = random.Float3(0.2f),
-								.Metallic = random.Float(0.4f),
-								.Roughness = random.Float(0.3f)
-							};
-						}
-
-						AddRenderObject(renderObject, position, PxSphereGeometry(0.075f)).setLinearVelocity({ 0, SimpleHarmonicMotion::Spring::CalculateVelocity(A, omega, 0.0f, position.x), 0 });
-					}
+				else if (renderObject.Name == ObjectNames::Moon) {
+					textures[to_underlying(TextureMapType::BaseColor)] = directoryPath / L"Moon_BaseColor.jpg";
+					textures[to_underlying(TextureMapType::Normal)] = directoryPath / L"Moon_Normal.jpg";
 				}
-			}
-
-			{
-				const struct {
-					LPCSTR Name;
-					PxVec3 Position;
-					PxReal Radius, RotationPeriod, OrbitalPeriod, Mass;
-					Material Material;
-				} moon{
-					.Name = ObjectNames::Moon,
-					.Position{ -4, 4, 0 },
-					.Radius = 0.25f,
-					.OrbitalPeriod = 10,
-					.Material{
-						.BaseColor = Vector4::One,
-						.Roughness = 0.8f
-					}
-				}, earth{
-					.Name = ObjectNames::Earth,
-					.Position{ 0, moon.Position.y, 0 },
-					.Radius = 1,
-					.RotationPeriod = 15,
-					.Mass = UniversalGravitation::CalculateMass((moon.Position - earth.Position).magnitude(), moon.OrbitalPeriod),
-					.Material{
-						.BaseColor = Vector4::One,
-						.Roughness = 0.8f
-					}
-				}, star{
-					.Name = ObjectNames::Star,
-					.Position{ 0, -50.1f, 0 },
-					.Radius = 50,
-					.Material{
-						.BaseColor{ 0.5f, 0.5f, 0.5f, 1 },
-						.Metallic = 1,
-						.Roughness = 0
-					}
-				};
-				for (const auto& [Name, Position, Radius, RotationPeriod, OrbitalPeriod, Mass, Material] : { moon, earth, star }) {
-					RenderObjectDesc renderObject;
-
-					renderObject.Name = Name;
-
-					renderObject.Material = Material;
-
-					auto& rigidDynamic = AddRenderObject(renderObject, Position, PxSphereGeometry(Radius));
-
-					if (auto& textures = RenderObjects.back().Textures;
-						renderObject.Name == ObjectNames::Moon) {
-						const auto x = earth.Position - Position;
-						const auto magnitude = x.magnitude();
-						const auto normalized = x / magnitude;
-						const auto linearSpeed = UniversalGravitation::CalculateFirstCosmicSpeed(earth.Mass, magnitude);
-						rigidDynamic.setLinearVelocity(linearSpeed * PxVec3(-normalized.z, 0, normalized.x));
-						rigidDynamic.setAngularVelocity({ 0, linearSpeed / magnitude, 0 });
-
-						textures[to_underlying(TextureMapType::BaseColor)] = directoryPath / L"Moon_BaseColor.jpg";
-						textures[to_underlying(TextureMapType::Normal)] = directoryPath / L"Moon_Normal.jpg";
-					}
-					else if (renderObject.Name == ObjectNames::Earth) {
-						rigidDynamic.setAngularVelocity({ 0, PxTwoPi / RotationPeriod, 0 });
-						PxRigidBodyExt::setMassAndUpdateInertia(rigidDynamic, &Mass, 1);
-
-						textures[to_underlying(TextureMapType::BaseColor)] = directoryPath / L"Earth_BaseColor.jpg";
-						textures[to_underlying(TextureMapType::Normal)] = directoryPath / L"Earth_Normal.jpg";
-					}
-					else if (renderObject.Name == ObjectNames::Star) {
-						rigidDynamic.setMass(0);
-					}
-
-					RigidActors[Name] = &rigidDynamic;
+				else if (renderObject.Name == ObjectNames::Earth) {
+					textures[to_underlying(TextureMapType::BaseColor)] = directoryPath / L"Earth_BaseColor.jpg";
+					textures[to_underlying(TextureMapType::Normal)] = directoryPath / L"Earth_Normal.jpg";
 				}
+
+				RenderObjects.emplace_back(move(renderObject));
 			}
 		}
 };
@@ -306,9 +76,11 @@ export {
 struct MyScene : Scene {
 	using Scene::Scene;
 
+	~MyScene() override { StopSimulation(); }
+
 	bool IsStatic() const override { return !m_isPhysXRunning; }
 
-	void Tick(double elapsedSeconds, const GamePad::ButtonStateTracker& gamepadStateTracker, const Keyboard::KeyboardStateTracker& keyboardStateTracker, const Mouse::ButtonStateTracker& mouseStateTracker) override {
+	void Tick([[maybe_unused]] double elapsedSeconds, const GamePad::ButtonStateTracker& gamepadStateTracker, const Keyboard::KeyboardStateTracker& keyboardStateTracker, const Mouse::ButtonStateTracker& mouseStateTracker) override {
 		if (mouseStateTracker.GetLastState().positionMode == Mouse::MODE_RELATIVE) {
 			if (gamepadStateTracker.a == GamepadButtonState::PRESSED) {
 				m_isPhysXRunning = !m_isPhysXRunning;
@@ -317,24 +89,25 @@ struct MyScene : Scene {
 				m_isPhysXRunning = !m_isPhysXRunning;
 			}
 
-			{
-				auto& isGravityEnabled = reinterpret_cast<bool&>(RigidActors.at(ObjectNames::Earth)->userData);
-				if (gamepadStateTracker.b == GamepadButtonState::PRESSED) {
-					isGravityEnabled = !isGravityEnabled;
-				}
-				if (keyboardStateTracker.IsKeyPressed(Key::G)) {
-					isGravityEnabled = !isGravityEnabled;
-				}
+			if (gamepadStateTracker.b == GamepadButtonState::PRESSED) {
+				m_simulation.IsEarthGravityEnabled = !m_simulation.IsEarthGravityEnabled;
+			}
+			if (keyboardStateTracker.IsKeyPressed(Key::G)) {
+				m_simulation.IsEarthGravityEnabled = !m_simulation.IsEarthGravityEnabled;
 			}
 
-			{
-				auto& isGravityEnabled = reinterpret_cast<bool&>(RigidActors.at(ObjectNames::Star)->userData);
-				if (gamepadStateTracker.y == GamepadButtonState::PRESSED) {
-					isGravityEnabled = !isGravityEnabled;
-				}
-				if (keyboardStateTracker.IsKeyPressed(Key::H)) {
-					isGravityEnabled = !isGravityEnabled;
-				}
+			if (gamepadStateTracker.y == GamepadButtonState::PRESSED) {
+				m_simulation.IsStarGravityEnabled = !m_simulation.IsStarGravityEnabled;
+			}
+			if (keyboardStateTracker.IsKeyPressed(Key::H)) {
+				m_simulation.IsStarGravityEnabled = !m_simulation.IsStarGravityEnabled;
+			}
+
+			if (gamepadStateTracker.rightShoulder == GamepadButtonState::PRESSED) {
+				m_simulation.IsMutualGravitationEnabled = !m_simulation.IsMutualGravitationEnabled;
+			}
+			if (keyboardStateTracker.IsKeyPressed(Key::N)) {
+				m_simulation.IsMutualGravitationEnabled = !m_simulation.IsMutualGravitationEnabled;
 			}
 		}
 
@@ -342,60 +115,33 @@ struct MyScene : Scene {
 			return;
 		}
 
-		Tick(elapsedSeconds);
-
 		Refresh();
 	}
 
 protected:
 	void Tick(double elapsedSeconds) override {
-		for (auto& renderObject : RenderObjects) {
-			const auto& shape = *renderObject.Shape;
-
-			const auto rigidBody = shape.getActor()->is<PxRigidBody>();
-			if (rigidBody == nullptr) {
-				continue;
-			}
-
-			rigidBody->setActorFlag(PxActorFlag::eDISABLE_SIMULATION, !renderObject.IsVisible);
-			if (!renderObject.IsVisible) {
-				continue;
-			}
-
-			const auto mass = rigidBody->getMass();
-			if (!mass) {
-				continue;
-			}
-
-			const auto& position = PxShapeExt::getGlobalPose(shape, *shape.getActor()).p;
-
-			if (renderObject.Name == ObjectNames::HarmonicOscillator) {
-				const auto k = SimpleHarmonicMotion::Spring::CalculateConstant(mass, Spring::Period);
-				const PxVec3 x(0, position.y - Spring::PositionY, 0);
-				rigidBody->addForce(-k * x);
-			}
-
-			if (const auto& earth = *RigidActors.at(ObjectNames::Earth)->is<PxRigidDynamic>();
-				(static_cast<bool>(earth.userData) && renderObject.Name != ObjectNames::Earth)
-				|| renderObject.Name == ObjectNames::Moon) {
-				const auto x = earth.getGlobalPose().p - position;
-				const auto magnitude = x.magnitude();
-				const auto normalized = x / magnitude;
-				rigidBody->addForce(UniversalGravitation::CalculateAccelerationMagnitude(earth.getMass(), magnitude) * normalized, PxForceMode::eACCELERATION);
+		if (!m_simulation.IsInitialized()) {
+			m_simulation.Initialize(RigidActors);
+			for (const auto& renderObject : RenderObjects) {
+				if (const auto rigidBody = renderObject.Shape->getActor()->is<PxRigidBody>()) {
+					m_simulation.AddBody(renderObject.Name, *rigidBody);
+				}
 			}
+		}
 
-			if (const auto& star = *RigidActors.at(ObjectNames::Star);
-				static_cast<bool>(star.userData) && renderObject.Name != ObjectNames::Star) {
-				const auto x = star.getGlobalPose().p - position;
-				const auto normalized = x.getNormalized();
-				rigidBody->addForce(10.0f * normalized, PxForceMode::eACCELERATION);
+		for (const auto& renderObject : RenderObjects) {
+			if (const auto rigidBody = renderObject.Shape->getActor()->is<PxRigidBody>();
+				rigidBody != nullptr && static_cast<bool>(rigidBody->getActorFlags() & PxActorFlag::eDISABLE_SIMULATION) == renderObject.IsVisible) {
+				rigidBody->setActorFlag(PxActorFlag::eDISABLE_SIMULATION, !renderObject.IsVisible);
 			}
 		}
 
-		PhysX->Tick(static_cast<float>(min(1.0 / 60, elapsedSeconds)));
+		m_simulation.Tick(*PhysX, elapsedSeconds);
 	}
 
 private:
-	bool m_isPhysXRunning = true;
+	atomic_bool m_isPhysXRunning = true;
+
+	MySimulation m_simulation;
 };
 }
@@ -0,0 +1,243 @@
+module;
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "PhysX.h"
+
+export module MySimulation;
+
+export import ForceFields;
+export import SceneGenerator;
+
+import PhysXCpuDispatcher;
+
+using namespace PhysicsHelpers;
+using namespace physx;
+using namespace std;
+
+#define MAKE_NAME(name) static constexpr const char* name = #name;
+
+export {
+	struct ObjectNames {
+		MAKE_NAME(AlienMetal);
+		MAKE_NAME(Earth);
+		MAKE_NAME(HarmonicOscillator);
+		MAKE_NAME(Moon);
+		MAKE_NAME(Sphere);
+		MAKE_NAME(Star);
+	};
+
+	struct Spring { static constexpr PxReal PositionY = 0.5f, Period = 3; };
+
+	struct MySimulationDesc {
+		struct Object {
+			string Name;
+			PxShape* Shape;
+			Material Material;
+		};
+
+		shared_ptr<::PhysX> PhysX;
+
+		vector<Object> Objects;
+
+		unordered_map<string, PxRigidActor*> RigidActors;
+
+		explicit MySimulationDesc(const SceneGenerator::Parameters& oscillators = { .Height = Spring::PositionY }, PxU32 threadCount = 0) {
+			PhysX = make_shared<::PhysX>(make_unique<PhysXCpuDispatcher>(threadCount));
+
+			const auto& material = *PhysX->GetPhysics().createMaterial(0.5f, 0.5f, 0.6f);
+
+			const auto AddObject = [&](const char* name, const auto& transform, const PxSphereGeometry& geometry, const Material& objectMaterial) -> decltype(auto) {
+				auto& rigidDynamic = *PhysX->GetPhysics().createRigidDynamic(PxTransform(transform));
+				PxRigidBodyExt::updateMassAndInertia(rigidDynamic, 1);
+				rigidDynamic.setAngularDamping(0);
+				PhysX->GetScene().addActor(rigidDynamic);
+
+				Objects.emplace_back(name == nullptr ? "" : name, PxRigidActorExt::createExclusiveShape(rigidDynamic, geometry, material), objectMaterial);
+
+				return rigidDynamic;
+			};
+
+			{
+				const struct {
+					const char* Name;
+					PxVec3 Position;
+					Material Material;
+				} objects[]{
+					{
+						.Name = ObjectNames::AlienMetal,
+						.Position{ -2, 0.5f, 0 },
+						.Material{
+							.BaseColor{ 1, 1, 1, 1 },
+							.Metallic = 1,
+							.Roughness = 1
+						}
+					},
+					{
+						.Position{ 0, 0.5f, 0 },
+						.Material{
+							.BaseColor{ 1, 1, 1, 1 },
+							.Roughness = 0,
+							.Transmission = 1
+						}
+					},
+					{
+						.Position{ 0, 2, 0 },
+						.Material{
+							.BaseColor{ 1, 1, 1, 1 },
+							.Roughness = 0.5f,
+							.Transmission = 1
+						}
+					},
+					{
+						.Position{ 2, 0.5f, 0 },
+						.Material{
+							.BaseColor{ 0.7f, 0.6f, 0.5f, 1 },
+							.Metallic = 1,
+							.Roughness = 0.3f
+						}
+					}
+				};
+				for (const auto& [Name, Position, Material] : objects) {
+					AddObject(Name, Position, PxSphereGeometry(0.5f), Material);
+				}
+
+				vector<SceneGenerator::Sphere> exclusions;
+				exclusions.reserve(size(objects));
+				for (const auto& object : objects) {
+					exclusions.emplace_back(object.Position, 1 - oscillators.MinRadius);
+				}
+				for (const auto& [Sphere, Material] : SceneGenerator::Generate(oscillators, exclusions)) {
+					constexpr auto A = 0.5f;
+					const auto omega = PxTwoPi / Spring::Period;
+
+					auto position = Sphere.Center;
+					position.y += SimpleHarmonicMotion::Spring::CalculateDisplacement(A, omega, 0.0f, position.x);
+
+					AddObject(ObjectNames::HarmonicOscillator, position, PxSphereGeometry(Sphere.Radius), Material).setLinearVelocity({ 0, SimpleHarmonicMotion::Spring::CalculateVelocity(A, omega, 0.0f, position.x), 0 });
+				}
+			}
+
+			{
+				const struct {
+					const char* Name;
+					PxVec3 Position;
+					PxReal Radius, RotationPeriod, OrbitalPeriod, Mass;
+					Material Material;
+				} moon{
+					.Name = ObjectNames::Moon,
+					.Position{ -4, 4, 0 },
+					.Radius = 0.25f,
+					.OrbitalPeriod = 10,
+					.Material{
+						.BaseColor{ 1, 1, 1, 1 },
+						.Roughness = 0.8f
+					}
+				}, earth{
+					.Name = ObjectNames::Earth,
+					.Position{ 0, moon.Position.y, 0 },
+					.Radius = 1,
+					.RotationPeriod = 15,
+					.Mass = UniversalGravitation::CalculateMass((moon.Position - earth.Position).magnitude(), moon.OrbitalPeriod),
+					.Material{
+						.BaseColor{ 1, 1, 1, 1 },
+						.Roughness = 0.8f
+					}
+				}, star{
+					.Name = ObjectNames::Star,
+					.Position{ 0, -50.1f, 0 },
+					.Radius = 50,
+					.Material{
+						.BaseColor{ 0.5f, 0.5f, 0.5f, 1 },
+						.Metallic = 1,
+						.Roughness = 0
+					}
+				};
+				for (const auto& [Name, Position, Radius, RotationPeriod, OrbitalPeriod, Mass, Material] : { moon, earth, star }) {
+					auto& rigidDynamic = AddObject(Name, Position, PxSphereGeometry(Radius), Material);
+
+					if (Name == ObjectNames::Moon) {
+						const auto x = earth.Position - Position;
+						const auto magnitude = x.magnitude();
+						const auto normalized = x / magnitude;
+						const auto linearSpeed = UniversalGravitation::CalculateFirstCosmicSpeed(earth.Mass, magnitude);
+						rigidDynamic.setLinearVelocity(linearSpeed * PxVec3(-normalized.z, 0, normalized.x));
+						rigidDynamic.setAngularVelocity({ 0, linearSpeed / magnitude, 0 });
+					}
+					else if (Name == ObjectNames::Earth) {
+						rigidDynamic.setAngularVelocity({ 0, PxTwoPi / RotationPeriod, 0 });
+						PxRigidBodyExt::setMassAndUpdateInertia(rigidDynamic, &Mass, 1);
+					}
+					else if (Name == ObjectNames::Star) {
+						rigidDynamic.setMass(0);
+					}
+
+					RigidActors[Name] = &rigidDynamic;
+				}
+			}
+		}
+	};
+
+	class MySimulation {
+	public:
+		atomic_bool IsEarthGravityEnabled{}, IsStarGravityEnabled{}, IsMutualGravitationEnabled{};
+
+		bool IsInitialized() const { return m_forceFieldSystem.GetBodyCount() != 0; }
+
+		void Initialize(const unordered_map<string, PxRigidActor*>& rigidActors) {
+			const auto& earth = *rigidActors.at(ObjectNames::Earth)->is<PxRigidBody>();
+			const auto& star = *rigidActors.at(ObjectNames::Star);
+
+			m_forceFieldSystem.Clear();
+			m_forceFields = {
+				.Spring = m_forceFieldSystem.Add(SpringField{ Spring::PositionY, Spring::Period }),
+				.EarthGravity = m_forceFieldSystem.Add(PointGravityField{ &earth }),
+				.MoonOrbit = m_forceFieldSystem.Add(PointGravityField{ &earth }),
+				.StarAttraction = m_forceFieldSystem.Add(DirectionalAttractorField{ &star, 10 }),
+				.MutualGravitation = m_forceFieldSystem.Add(MutualGravitationField{})
+			};
+		}
+
+		void AddBody(const string& name, PxRigidBody& rigidBody) {
+			auto fields = m_forceFields.MutualGravitation;
+			if (name == ObjectNames::HarmonicOscillator) {
+				fields |= m_forceFields.Spring;
+			}
+			if (name == ObjectNames::Moon) {
+				fields |= m_forceFields.MoonOrbit;
+			}
+			else if (name != ObjectNames::Earth) {
+				fields |= m_forceFields.EarthGravity;
+			}
+			if (name != ObjectNames::Star) {
+				fields |= m_forceFields.StarAttraction;
+			}
+			m_forceFieldSystem.AddBody(rigidBody, fields);
+		}
+
+		void ApplyForceFields() {
+			m_forceFieldSystem.SetEnabled(m_forceFields.EarthGravity, !IsMutualGravitationEnabled && IsEarthGravityEnabled);
+			m_forceFieldSystem.SetEnabled(m_forceFields.MoonOrbit, !IsMutualGravitationEnabled);
+			m_forceFieldSystem.SetEnabled(m_forceFields.MutualGravitation, IsMutualGravitationEnabled);
+			m_forceFieldSystem.SetEnabled(m_forceFields.StarAttraction, IsStarGravityEnabled);
+			m_forceFieldSystem.Apply();
+		}
+
+		void Tick(::PhysX& physX, double elapsedSeconds) {
+			ApplyForceFields();
+
+			physX.Tick(static_cast<float>(min(1.0 / 60, elapsedSeconds)));
+		}
+
+	private:
+		ForceFieldSystem m_forceFieldSystem;
+		struct {
+			ForceFieldMask Spring, EarthGravity, MoonOrbit, StarAttraction, MutualGravitation;
+		} m_forceFields{};
+	};
+}
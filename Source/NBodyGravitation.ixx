@@ -0,0 +1,448 @@
+module;
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <span>
+#include <vector>
+
+#include <DirectXMath.h>
+
+#include "PhysX.h"
+
+export module NBodyGravitation;
+
+import Random;
+import ThreadHelpers;
+
+using namespace DirectX;
+using namespace PhysicsHelpers;
+using namespace std;
+using namespace std::chrono;
+using namespace ThreadHelpers;
+
+namespace {
+	XMVECTOR LoadPacket(span<const float> values, size_t index) {
+		if (index + 4 <= size(values)) {
+			return XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&values[index]));
+		}
+		XMFLOAT4 packet{};
+		copy(cbegin(values) + index, cend(values), &packet.x);
+		return XMLoadFloat4(&packet);
+	}
+
+	void StorePacket(span<float> values, size_t index, FXMVECTOR packet) {
+		if (index + 4 <= size(values)) {
+			XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&values[index]), packet);
+			return;
+		}
+		XMFLOAT4 value;
+		XMStoreFloat4(&value, packet);
+		copy_n(&value.x, size(values) - index, begin(values) + index);
+	}
+
+	constexpr uint64_t ExpandBits(uint64_t value) {
+		value &= 0x1fffff;
+		value = (value | value << 32) & 0x1f00000000ffff;
+		value = (value | value << 16) & 0x1f0000ff0000ff;
+		value = (value | value << 8) & 0x100f00f00f00f00f;
+		value = (value | value << 4) & 0x10c30c30c30c30c3;
+		value = (value | value << 2) & 0x1249249249249249;
+		return value;
+	}
+}
+
+export namespace NBodyGravitation {
+	struct Bodies {
+		span<const float> X, Y, Z, Mass;
+
+		size_t size() const { return std::size(Mass); }
+	};
+
+	struct Accelerations {
+		span<float> X, Y, Z;
+	};
+
+	enum class Method { Automatic, Exact, BarnesHut };
+
+	struct Parameters {
+		float GravitationalConstant = static_cast<float>(UniversalGravitation::G), Softening = 1e-3f;
+
+		float OpeningAngle = 0.5f;
+
+		size_t ExactThreshold = 4096;
+	};
+
+	void ComputeExact(const Bodies& bodies, const Accelerations& accelerations, const Parameters& parameters) {
+		const auto softeningSquared = XMVectorReplicate(parameters.Softening * parameters.Softening);
+		const auto bodyCount = size(bodies);
+		ParallelFor((bodyCount + 3) / 4, 64, [&](size_t first, size_t last) {
+			for (auto i = first * 4; i < last * 4; i += 4) {
+				const auto x = LoadPacket(bodies.X, i), y = LoadPacket(bodies.Y, i), z = LoadPacket(bodies.Z, i);
+
+				auto accelerationX = XMVectorZero(), accelerationY = XMVectorZero(), accelerationZ = XMVectorZero();
+				for (size_t j = 0; j < bodyCount; j++) {
+					const auto
+						dx = XMVectorSubtract(XMVectorReplicatePtr(&bodies.X[j]), x),
+						dy = XMVectorSubtract(XMVectorReplicatePtr(&bodies.Y[j]), y),
+						dz = XMVectorSubtract(XMVectorReplicatePtr(&bodies.Z[j]), z);
+					const auto distanceSquared = XMVectorAdd(XMVectorMultiplyAdd(dz, dz, XMVectorMultiplyAdd(dy, dy, XMVectorMultiply(dx, dx))), softeningSquared);
+					const auto reciprocalDistance = XMVectorReciprocalSqrt(distanceSquared);
+					const auto scale = XMVectorSelect(
+						XMVectorZero(),
+						XMVectorMultiply(XMVectorReplicatePtr(&bodies.Mass[j]), XMVectorMultiply(reciprocalDistance, XMVectorMultiply(reciprocalDistance, reciprocalDistance))),
+						XMVectorGreater(distanceSquared, XMVectorZero())
+					);
+					accelerationX = XMVectorMultiplyAdd(scale, dx, accelerationX);
+					accelerationY = XMVectorMultiplyAdd(scale, dy, accelerationY);
+					accelerationZ = XMVectorMultiplyAdd(scale, dz, accelerationZ);
+				}
+
+				const auto G = XMVectorReplicate(parameters.GravitationalConstant);
+				StorePacket(accelerations.X, i, XMVectorMultiply(G, accelerationX));
+				StorePacket(accelerations.Y, i, XMVectorMultiply(G, accelerationY));
+				StorePacket(accelerations.Z, i, XMVectorMultiply(G, accelerationZ));
+			}
+		});
+	}
+
+	class Octree {
+	public:
+		static constexpr uint32_t MaxDepth = 21, ParallelDepth = 2, LeafSize = 8;
+		static constexpr size_t BatchSize = 4096;
+
+		void Build(const Bodies& bodies) {
+			const auto bodyCount = size(bodies);
+
+			m_nodes.clear();
+			if (!bodyCount) {
+				return;
+			}
+
+			vector<pair<XMFLOAT3, XMFLOAT3>> batchBounds((bodyCount + BatchSize - 1) / BatchSize);
+			ParallelFor(bodyCount, BatchSize, [&](size_t first, size_t last) {
+				auto& [min, max] = batchBounds[first / BatchSize];
+				min = max = { bodies.X[first], bodies.Y[first], bodies.Z[first] };
+				for (auto i = first + 1; i < last; i++) {
+					min = { std::min(min.x, bodies.X[i]), std::min(min.y, bodies.Y[i]), std::min(min.z, bodies.Z[i]) };
+					max = { std::max(max.x, bodies.X[i]), std::max(max.y, bodies.Y[i]), std::max(max.z, bodies.Z[i]) };
+				}
+			});
+			auto [min, max] = batchBounds.front();
+			for (const auto& bounds : batchBounds) {
+				min = { std::min(min.x, bounds.first.x), std::min(min.y, bounds.first.y), std::min(min.z, bounds.first.z) };
+				max = { std::max(max.x, bounds.second.x), std::max(max.y, bounds.second.y), std::max(max.z, bounds.second.z) };
+			}
+			m_origin = min;
+			m_size = std::max({ max.x - min.x, max.y - min.y, max.z - min.z, numeric_limits<float>::min() });
+
+			m_codes.resize(bodyCount);
+			m_order.resize(bodyCount);
+			ParallelFor(bodyCount, BatchSize, [&](size_t first, size_t last) {
+				constexpr auto Scale = static_cast<float>(1 << MaxDepth);
+				const auto Quantize = [&](float value, float origin) {
+					return static_cast<uint64_t>(std::clamp((value - origin) / m_size * Scale, 0.0f, Scale - 1));
+				};
+				for (auto i = first; i < last; i++) {
+					m_codes[i] = ExpandBits(Quantize(bodies.X[i], m_origin.x)) << 2 | ExpandBits(Quantize(bodies.Y[i], m_origin.y)) << 1 | ExpandBits(Quantize(bodies.Z[i], m_origin.z));
+					m_order[i] = static_cast<uint32_t>(i);
+				}
+			});
+			SortOrder();
+
+			m_sortedCodes.resize(bodyCount);
+			for (auto pArray : { &m_x, &m_y, &m_z, &m_mass }) {
+				pArray->resize(bodyCount);
+			}
+			ParallelFor(bodyCount, BatchSize, [&](size_t first, size_t last) {
+				for (auto i = first; i < last; i++) {
+					const auto index = m_order[i];
+					m_sortedCodes[i] = m_codes[index];
+					m_x[i] = bodies.X[index];
+					m_y[i] = bodies.Y[index];
+					m_z[i] = bodies.Z[index];
+					m_mass[i] = bodies.Mass[index];
+				}
+			});
+
+			m_nodes = BuildSubtree(0, static_cast<uint32_t>(bodyCount), 0);
+		}
+
+		void ComputeAccelerations(const Accelerations& accelerations, const Parameters& parameters) const {
+			if (empty(m_nodes)) {
+				return;
+			}
+
+			const auto
+				openingAngleSquared = parameters.OpeningAngle * parameters.OpeningAngle,
+				softeningSquared = parameters.Softening * parameters.Softening;
+			ParallelFor(size(m_order), 256, [&](size_t first, size_t last) {
+				vector<uint32_t> stack;
+				for (auto i = first; i < last; i++) {
+					const auto x = m_x[i], y = m_y[i], z = m_z[i];
+					float accelerationX = 0, accelerationY = 0, accelerationZ = 0;
+					const auto Accumulate = [&](float sourceX, float sourceY, float sourceZ, float mass) {
+						const auto dx = sourceX - x, dy = sourceY - y, dz = sourceZ - z;
+						if (const auto distanceSquared = dx * dx + dy * dy + dz * dz + softeningSquared; distanceSquared > 0) {
+							const auto reciprocalDistance = 1 / sqrt(distanceSquared);
+							const auto scale = mass * reciprocalDistance * reciprocalDistance * reciprocalDistance;
+							accelerationX += scale * dx;
+							accelerationY += scale * dy;
+							accelerationZ += scale * dz;
+						}
+					};
+
+					stack.assign(1, 0);
+					while (!empty(stack)) {
+						const auto& node = m_nodes[stack.back()];
+						stack.pop_back();
+
+						if (!node.ChildCount) {
+							for (auto j = node.FirstBody; j < node.FirstBody + node.BodyCount; j++) {
+								Accumulate(m_x[j], m_y[j], m_z[j], m_mass[j]);
+							}
+							continue;
+						}
+
+						const auto dx = node.X - x, dy = node.Y - y, dz = node.Z - z;
+						if (node.Size * node.Size < openingAngleSquared * (dx * dx + dy * dy + dz * dz)) {
+							Accumulate(node.X, node.Y, node.Z, node.Mass);
+							continue;
+						}
+
+						for (auto j = node.FirstChild; j < node.FirstChild + node.ChildCount; j++) {
+							stack.emplace_back(j);
+						}
+					}
+
+					const auto index = m_order[i];
+					accelerations.X[index] = parameters.GravitationalConstant * accelerationX;
+					accelerations.Y[index] = parameters.GravitationalConstant * accelerationY;
+					accelerations.Z[index] = parameters.GravitationalConstant * accelerationZ;
+				}
+			});
+		}
+
+		size_t GetNodeCount() const { return size(m_nodes); }
+
+	private:
+		struct Node {
+			float X, Y, Z, Mass, Size;
+			uint32_t FirstChild, ChildCount, FirstBody, BodyCount;
+		};
+
+		XMFLOAT3 m_origin{};
+		float m_size{};
+
+		vector<uint64_t> m_codes, m_sortedCodes;
+		vector<uint32_t> m_order;
+		vector<float> m_x, m_y, m_z, m_mass;
+
+		vector<Node> m_nodes;
+
+		void SortOrder() {
+			const auto bodyCount = size(m_order);
+			const auto Compare = [&](uint32_t a, uint32_t b) { return m_codes[a] < m_codes[b]; };
+
+			ParallelFor(bodyCount, BatchSize, [&](size_t first, size_t last) { sort(begin(m_order) + first, begin(m_order) + last, Compare); });
+
+			for (size_t width = BatchSize; width < bodyCount; width *= 2) {
+				ParallelFor((bodyCount + 2 * width - 1) / (2 * width), 1, [&](size_t first, size_t last) {
+					for (auto i = first; i < last; i++) {
+						const auto begin = i * 2 * width, middle = std::min(begin + width, bodyCount), end = std::min(begin + 2 * width, bodyCount);
+						inplace_merge(std::begin(m_order) + begin, std::begin(m_order) + middle, std::begin(m_order) + end, Compare);
+					}
+				});
+			}
+		}
+
+		auto SplitRange(uint32_t first, uint32_t last, uint32_t depth) const {
+			vector<pair<uint32_t, uint32_t>> ranges;
+			const auto shift = 3 * (MaxDepth - depth - 1);
+			for (auto begin = first; begin < last;) {
+				const auto octant = m_sortedCodes[begin] >> shift & 7;
+				const auto end = static_cast<uint32_t>(partition_point(cbegin(m_sortedCodes) + begin, cbegin(m_sortedCodes) + last, [&](uint64_t code) {
+					return (code >> shift & 7) == octant;
+				}) - cbegin(m_sortedCodes));
+				ranges.emplace_back(begin, end);
+				begin = end;
+			}
+			return ranges;
+		}
+
+		Node CreateNode(uint32_t first, uint32_t last, uint32_t depth) const {
+			return {
+				.Size = m_size / static_cast<float>(1 << depth),
+				.FirstBody = first,
+				.BodyCount = last - first
+			};
+		}
+
+		static void AccumulateMass(Node& node, float x, float y, float z, float mass) {
+			node.X += mass * x;
+			node.Y += mass * y;
+			node.Z += mass * z;
+			node.Mass += mass;
+		}
+
+		static void NormalizeMass(Node& node) {
+			if (node.Mass > 0) {
+				node.X /= node.Mass;
+				node.Y /= node.Mass;
+				node.Z /= node.Mass;
+			}
+		}
+
+		bool IsLeaf(uint32_t first, uint32_t last, uint32_t depth) const { return last - first <= LeafSize || depth == MaxDepth; }
+
+		void BuildNode(vector<Node>& nodes, size_t index, uint32_t first, uint32_t last, uint32_t depth) const {
+			auto node = CreateNode(first, last, depth);
+			if (IsLeaf(first, last, depth)) {
+				for (auto i = first; i < last; i++) {
+					AccumulateMass(node, m_x[i], m_y[i], m_z[i], m_mass[i]);
+				}
+			}
+			else {
+				const auto ranges = SplitRange(first, last, depth);
+				node.FirstChild = static_cast<uint32_t>(size(nodes));
+				node.ChildCount = static_cast<uint32_t>(size(ranges));
+				nodes.resize(size(nodes) + size(ranges));
+				for (uint32_t i = 0; i < node.ChildCount; i++) {
+					BuildNode(nodes, node.FirstChild + i, ranges[i].first, ranges[i].second, depth + 1);
+					const auto& child = nodes[node.FirstChild + i];
+					AccumulateMass(node, child.X, child.Y, child.Z, child.Mass);
+				}
+			}
+			NormalizeMass(node);
+			nodes[index] = node;
+		}
+
+		vector<Node> BuildSubtree(uint32_t first, uint32_t last, uint32_t depth) const {
+			vector<Node> nodes(1);
+			if (depth >= ParallelDepth || IsLeaf(first, last, depth)) {
+				BuildNode(nodes, 0, first, last, depth);
+				return nodes;
+			}
+
+			const auto ranges = SplitRange(first, last, depth);
+			vector<vector<Node>> subtrees(size(ranges));
+			ParallelFor(size(ranges), 1, [&](size_t first, size_t last) {
+				for (auto i = first; i < last; i++) {
+					subtrees[i] = BuildSubtree(ranges[i].first, ranges[i].second, depth + 1);
+				}
+			});
+
+			auto node = CreateNode(first, last, depth);
+			node.FirstChild = 1;
+			node.ChildCount = static_cast<uint32_t>(size(subtrees));
+
+			size_t nodeCount = 1 + size(subtrees);
+			for (const auto& subtree : subtrees) {
+				nodeCount += size(subtree) - 1;
+			}
+			nodes.reserve(nodeCount);
+			nodes.resize(1 + size(subtrees));
+
+			for (size_t i = 0; i < size(subtrees); i++) {
+				const auto offset = static_cast<uint32_t>(size(nodes)) - 1;
+				const auto Relocate = [&](Node subtreeNode) {
+					if (subtreeNode.ChildCount) {
+						subtreeNode.FirstChild += offset;
+					}
+					return subtreeNode;
+				};
+
+				const auto& subtree = subtrees[i];
+				nodes[1 + i] = Relocate(subtree.front());
+				for (auto j = cbegin(subtree) + 1; j != cend(subtree); ++j) {
+					nodes.emplace_back(Relocate(*j));
+				}
+
+				const auto& child = nodes[1 + i];
+				AccumulateMass(node, child.X, child.Y, child.Z, child.Mass);
+			}
+			NormalizeMass(node);
+			nodes.front() = node;
+
+			return nodes;
+		}
+	};
+
+	void Compute(const Bodies& bodies, const Accelerations& accelerations, const Parameters& parameters, Octree& octree, Method method = Method::Automatic) {
+		if (method == Method::Automatic) {
+			method = size(bodies) <= parameters.ExactThreshold ? Method::Exact : Method::BarnesHut;
+		}
+
+		if (method == Method::Exact) {
+			ComputeExact(bodies, accelerations, parameters);
+		}
+		else {
+			octree.Build(bodies);
+			octree.ComputeAccelerations(accelerations, parameters);
+		}
+	}
+
+	struct BenchmarkResult {
+		NBodyGravitation::Method Method;
+		float OpeningAngle;
+		double Seconds, MeanRelativeError, MaxRelativeError;
+	};
+
+	vector<BenchmarkResult> RunBenchmark(size_t bodyCount, span<const float> openingAngles, unsigned int seed = 0) {
+		vector<float> x(bodyCount), y(bodyCount), z(bodyCount), mass(bodyCount);
+		Random random(seed);
+		for (size_t i = 0; i < bodyCount; i++) {
+			XMFLOAT3 position;
+			do {
+				position = random.Float3(-1, 1);
+			} while (position.x * position.x + position.y * position.y + position.z * position.z > 1);
+			x[i] = position.x;
+			y[i] = position.y;
+			z[i] = position.z;
+			mass[i] = random.Float(0.5f, 1.5f) / static_cast<float>(bodyCount);
+		}
+		const Bodies bodies{ x, y, z, mass };
+
+		Parameters parameters{ .GravitationalConstant = 1, .Softening = 1e-2f };
+
+		Octree octree;
+
+		const auto Measure = [&](const Accelerations& accelerations, Method method) {
+			const auto start = steady_clock::now();
+			Compute(bodies, accelerations, parameters, octree, method);
+			return duration<double>(steady_clock::now() - start).count();
+		};
+
+		vector<float> exactX(bodyCount), exactY(bodyCount), exactZ(bodyCount);
+		vector<BenchmarkResult> results{ { .Method = Method::Exact, .Seconds = Measure({ exactX, exactY, exactZ }, Method::Exact) } };
+
+		vector<float> approximateX(bodyCount), approximateY(bodyCount), approximateZ(bodyCount);
+		for (const auto openingAngle : openingAngles) {
+			parameters.OpeningAngle = openingAngle;
+
+			BenchmarkResult result{
+				.Method = Method::BarnesHut,
+				.OpeningAngle = openingAngle,
+				.Seconds = Measure({ approximateX, approximateY, approximateZ }, Method::BarnesHut)
+			};
+			for (size_t i = 0; i < bodyCount; i++) {
+				const auto
+					dx = static_cast<double>(approximateX[i]) - exactX[i],
+					dy = static_cast<double>(approximateY[i]) - exactY[i],
+					dz = static_cast<double>(approximateZ[i]) - exactZ[i];
+				const auto magnitude = sqrt(static_cast<double>(exactX[i]) * exactX[i] + static_cast<double>(exactY[i]) * exactY[i] + static_cast<double>(exactZ[i]) * exactZ[i]);
+				if (magnitude > 0) {
+					const auto error = sqrt(dx * dx + dy * dy + dz * dz) / magnitude;
+					result.MeanRelativeError += error;
+					result.MaxRelativeError = std::max(result.MaxRelativeError, error);
+				}
+			}
+			if (bodyCount) {
+				result.MeanRelativeError /= static_cast<double>(bodyCount);
+			}
+			results.emplace_back(result);
+		}
+
+		return results;
+	}
+}
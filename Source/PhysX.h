@@ -4,8 +4,11 @@
 #pragma warning(disable: 4996 26451 26495 26812 33010)
 
 #include <cmath>
+#include <memory>
+#include <mutex>
 #include <numbers>
 #include <stdexcept>
+#include <string>
 
 #include "physx/PxPhysicsAPI.h"
 
@@ -38,27 +41,40 @@ namespace PhysicsHelpers {
 #pragma warning(pop)
 
 struct PhysX {
+	struct VisualDebuggerDesc {
+		enum class TransportType { Socket, File };
+		TransportType Transport = TransportType::Socket;
+
+		std::string Host = "localhost";
+		int Port = 5425;
+		unsigned int TimeoutMilliseconds = 10;
+
+		std::string FilePath = "PhysX.pxd2";
+
+		physx::PxPvdInstrumentationFlags InstrumentationFlags = physx::PxPvdInstrumentationFlag::eALL;
+	};
+
 	PhysX(const PhysX&) = delete;
 	PhysX& operator=(const PhysX&) = delete;
 
-	explicit PhysX(physx::PxU32 threadCount) noexcept(false) {
+	explicit PhysX(std::unique_ptr<physx::PxCpuDispatcher> cpuDispatcher) noexcept(false) : m_cpuDispatcher(std::move(cpuDispatcher)) {
 		using namespace physx;
 
 		auto& foundation = *_.Foundation;
 
-		m_defaultCpuDispatcher = PxDefaultCpuDispatcherCreate(threadCount);
-
 		PxTolerancesScale tolerancesScale;
 		tolerancesScale.speed = 3;
 
-		m_physics = PxCreatePhysics(PX_PHYSICS_VERSION, foundation, tolerancesScale, false, _.Pvd);
+		const auto pvd = GetVisualDebugger();
+
+		m_physics = PxCreatePhysics(PX_PHYSICS_VERSION, foundation, tolerancesScale, false, pvd);
 
 		PxSceneDesc sceneDesc(tolerancesScale);
-		sceneDesc.cpuDispatcher = m_defaultCpuDispatcher;
+		sceneDesc.cpuDispatcher = m_cpuDispatcher.get();
 		sceneDesc.filterShader = PxDefaultSimulationFilterShader;
 		m_scene = m_physics->createScene(sceneDesc);
 
-		if (const auto scenePvdClient = m_scene->getScenePvdClient()) {
+		if (const auto scenePvdClient = m_scene->getScenePvdClient(); pvd != nullptr && scenePvdClient != nullptr) {
 			scenePvdClient->setScenePvdFlags(PxPvdSceneFlag::eTRANSMIT_CONSTRAINTS | PxPvdSceneFlag::eTRANSMIT_CONTACTS | PxPvdSceneFlag::eTRANSMIT_SCENEQUERIES);
 		}
 	}
@@ -67,21 +83,52 @@ struct PhysX {
 		m_scene->release();
 
 		m_physics->release();
-
-		m_defaultCpuDispatcher->release();
 	}
 
 	auto& GetPhysics() const noexcept { return *m_physics; }
 
 	auto& GetScene() const noexcept { return *m_scene; }
 
+	static bool EnableVisualDebugger(const VisualDebuggerDesc& desc) {
+		using namespace physx;
+
+		const std::scoped_lock lock(_.Mutex);
+
+		if (_.Pvd != nullptr) {
+			return true;
+		}
+
+		const auto transport = desc.Transport == VisualDebuggerDesc::TransportType::File ?
+			PxDefaultPvdFileTransportCreate(desc.FilePath.c_str()) :
+			PxDefaultPvdSocketTransportCreate(desc.Host.c_str(), desc.Port, desc.TimeoutMilliseconds);
+		if (transport == nullptr) {
+			return false;
+		}
+
+		const auto pvd = PxCreatePvd(*_.Foundation);
+		if (!pvd->connect(*transport, desc.InstrumentationFlags)) {
+			pvd->release();
+			transport->release();
+			return false;
+		}
+
+		_.Pvd = pvd;
+
+		return true;
+	}
+
+	static physx::PxPvd* GetVisualDebugger() {
+		const std::scoped_lock lock(_.Mutex);
+		return _.Pvd;
+	}
+
 	void Tick(float elapsedTime, bool block = true) {
 		m_scene->simulate(elapsedTime);
 		m_scene->fetchResults(block);
 	}
 
 private:
-	inline static const struct _ {
+	inline static struct _ {
 		struct PxAllocator : physx::PxDefaultAllocator {
 			void* allocate(size_t size, const char* typeName, const char* filename, int line) override {
 				void* ptr = PxDefaultAllocator::allocate(size, typeName, filename, line);
@@ -96,24 +143,22 @@ private:
 
 		physx::PxFoundation* Foundation = PxCreateFoundation(PX_PHYSICS_VERSION, AllocatorCallback, ErrorCallback);
 
-		physx::PxPvd* Pvd = PxCreatePvd(*Foundation);
+		std::mutex Mutex;
 
-		_() {
-			using namespace physx;
-
-			Pvd->connect(*PxDefaultPvdSocketTransportCreate("localhost", 5425, 10), PxPvdInstrumentationFlag::eALL);
-		}
+		physx::PxPvd* Pvd{};
 
 		~_() {
-			Pvd->disconnect();
-			Pvd->getTransport()->release();
-			Pvd->release();
+			if (Pvd != nullptr) {
+				Pvd->disconnect();
+				Pvd->getTransport()->release();
+				Pvd->release();
+			}
 
 			Foundation->release();
 		}
 	} _;
 
-	physx::PxDefaultCpuDispatcher* m_defaultCpuDispatcher{};
+	std::unique_ptr<physx::PxCpuDispatcher> m_cpuDispatcher;
 
 	physx::PxPhysics* m_physics{};
 
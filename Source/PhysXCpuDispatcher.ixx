@@ -0,0 +1,59 @@
+module;
+
+#include <algorithm>
+#include <deque>
+#include <mutex>
+
+#include "PhysX.h"
+
+export module PhysXCpuDispatcher;
+
+import ThreadHelpers;
+
+using namespace physx;
+using namespace std;
+using namespace ThreadHelpers;
+
+export struct PhysXCpuDispatcher : PxCpuDispatcher {
+	explicit PhysXCpuDispatcher(PxU32 maxWorkerCount = 0, TaskScheduler& taskScheduler = TaskScheduler::Get()) :
+		m_taskScheduler(taskScheduler),
+		m_workerCount(static_cast<PxU32>(maxWorkerCount ? min<size_t>(maxWorkerCount, taskScheduler.GetThreadCount()) : taskScheduler.GetThreadCount())) {}
+
+	void submitTask(PxBaseTask& task) override {
+		{
+			const scoped_lock lock(m_mutex);
+			if (m_activeWorkerCount == m_workerCount) {
+				m_pendingTasks.emplace_back(&task);
+				return;
+			}
+			m_activeWorkerCount++;
+		}
+
+		m_taskScheduler.Submit([this, pTask = &task]() mutable {
+			while (pTask) {
+				pTask->run();
+				pTask->release();
+
+				const scoped_lock lock(m_mutex);
+				if (empty(m_pendingTasks)) {
+					pTask = nullptr;
+					m_activeWorkerCount--;
+				}
+				else {
+					pTask = m_pendingTasks.front();
+					m_pendingTasks.pop_front();
+				}
+			}
+		}, TaskPriority::High);
+	}
+
+	PxU32 getWorkerCount() const override { return m_workerCount; }
+
+private:
+	TaskScheduler& m_taskScheduler;
+	PxU32 m_workerCount;
+
+	mutex m_mutex;
+	PxU32 m_activeWorkerCount{};
+	deque<PxBaseTask*> m_pendingTasks;
+};
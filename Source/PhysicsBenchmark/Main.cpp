@@ -0,0 +1,211 @@
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <print>
+#include <string_view>
+#include <vector>
+
+#include "nlohmann/json.hpp"
+
+#include "PhysX.h"
+
+import MySimulation;
+import PoseStream;
+import ThreadHelpers;
+
+using namespace physx;
+using namespace std;
+using namespace std::chrono;
+using namespace ThreadHelpers;
+
+namespace {
+	struct Options {
+		size_t FrameCount = 600;
+		uint32_t OscillatorCount = 21 * 21, Seed{}, ThreadCount{};
+		double TimeStep = 1.0 / 60;
+		bool IsEarthGravityEnabled{}, IsStarGravityEnabled{}, IsMutualGravitationEnabled{};
+		string OutputPath, VisualDebuggerFilePath, PoseStreamFilePath;
+	};
+
+	struct PhaseTiming {
+		double TotalSeconds{}, MaxSeconds{};
+
+		void Add(double seconds) {
+			TotalSeconds += seconds;
+			MaxSeconds = max(MaxSeconds, seconds);
+		}
+
+		nlohmann::ordered_json ToJSON(size_t frameCount) const {
+			return {
+				{ "TotalMilliseconds", TotalSeconds * 1000 },
+				{ "MeanMilliseconds", frameCount ? TotalSeconds * 1000 / static_cast<double>(frameCount) : 0 },
+				{ "MaxMilliseconds", MaxSeconds * 1000 }
+			};
+		}
+	};
+
+	Options ParseOptions(int argc, char* argv[]) {
+		Options options;
+		for (int i = 1; i < argc; i++) {
+			const string_view argument = argv[i];
+			const auto GetValue = [&] {
+				if (i + 1 == argc) {
+					throw invalid_argument(format("Missing value for {}", argument));
+				}
+				return argv[++i];
+			};
+			if (argument == "--frames") options.FrameCount = stoull(GetValue());
+			else if (argument == "--oscillators") options.OscillatorCount = static_cast<uint32_t>(stoul(GetValue()));
+			else if (argument == "--seed") options.Seed = static_cast<uint32_t>(stoul(GetValue()));
+			else if (argument == "--threads") options.ThreadCount = static_cast<uint32_t>(stoul(GetValue()));
+			else if (argument == "--dt") options.TimeStep = stod(GetValue());
+			else if (argument == "--earth-gravity") options.IsEarthGravityEnabled = true;
+			else if (argument == "--star-gravity") options.IsStarGravityEnabled = true;
+			else if (argument == "--mutual-gravitation") options.IsMutualGravitationEnabled = true;
+			else if (argument == "--output") options.OutputPath = GetValue();
+			else if (argument == "--pvd-file") options.VisualDebuggerFilePath = GetValue();
+			else if (argument == "--record-poses") options.PoseStreamFilePath = GetValue();
+			else throw invalid_argument(format("Unknown argument {}", argument));
+		}
+		if (!(options.TimeStep > 0)) {
+			throw invalid_argument("--dt must be positive");
+		}
+		return options;
+	}
+
+	void CapturePoses(const MySimulationDesc& simulationDesc, vector<PxTransform>& poses) {
+		poses.resize(size(simulationDesc.Objects));
+		for (size_t i = 0; i < size(poses); i++) {
+			const auto& shape = *simulationDesc.Objects[i].Shape;
+			poses[i] = PxShapeExt::getGlobalPose(shape, *shape.getActor());
+		}
+	}
+
+	uint64_t CalculatePoseChecksum(const MySimulationDesc& simulationDesc) {
+		uint64_t checksum = 0xcbf29ce484222325;
+		for (const auto& object : simulationDesc.Objects) {
+			const auto pose = object.Shape->getActor()->getGlobalPose();
+			const PxReal values[]{ pose.p.x, pose.p.y, pose.p.z, pose.q.x, pose.q.y, pose.q.z, pose.q.w };
+			uint8_t bytes[sizeof(values)];
+			memcpy(bytes, values, sizeof(values));
+			for (const auto byte : bytes) {
+				checksum = (checksum ^ byte) * 0x100000001b3;
+			}
+		}
+		return checksum;
+	}
+}
+
+int main(int argc, char* argv[]) {
+	try {
+		const auto options = ParseOptions(argc, argv);
+
+		if (!empty(options.VisualDebuggerFilePath)
+			&& !PhysX::EnableVisualDebugger({ .Transport = PhysX::VisualDebuggerDesc::TransportType::File, .FilePath = options.VisualDebuggerFilePath })) {
+			throw runtime_error(format("Failed to open {}", options.VisualDebuggerFilePath));
+		}
+
+		const auto gridSize = static_cast<uint32_t>(ceil(sqrt(static_cast<double>(options.OscillatorCount))));
+		MySimulationDesc simulationDesc({
+			.GridSize = gridSize,
+			.ObjectCount = options.OscillatorCount,
+			.Height = Spring::PositionY,
+			.Seed = options.Seed
+		}, options.ThreadCount);
+
+		MySimulation simulation;
+		simulation.Initialize(simulationDesc.RigidActors);
+		for (const auto& object : simulationDesc.Objects) {
+			if (const auto rigidBody = object.Shape->getActor()->is<PxRigidBody>()) {
+				simulation.AddBody(object.Name, *rigidBody);
+			}
+		}
+		simulation.IsEarthGravityEnabled = options.IsEarthGravityEnabled;
+		simulation.IsStarGravityEnabled = options.IsStarGravityEnabled;
+		simulation.IsMutualGravitationEnabled = options.IsMutualGravitationEnabled;
+
+		auto& scene = simulationDesc.PhysX->GetScene();
+		const auto timeStep = static_cast<PxReal>(options.TimeStep);
+
+		PhaseTiming forceFields, simulate, fetchResults;
+		const auto Measure = [](PhaseTiming& timing, auto&& function) {
+			const auto start = steady_clock::now();
+			function();
+			timing.Add(duration<double>(steady_clock::now() - start).count());
+		};
+
+		unique_ptr<PoseStream::Writer> poseWriter;
+		vector<PxTransform> poses;
+		if (!empty(options.PoseStreamFilePath)) {
+			poseWriter = make_unique<PoseStream::Writer>(options.PoseStreamFilePath, static_cast<uint32_t>(size(simulationDesc.Objects)), options.TimeStep);
+			CapturePoses(simulationDesc, poses);
+			poseWriter->Write(poses);
+		}
+
+		auto seconds = 0.0;
+		for (size_t i = 0; i < options.FrameCount; i++) {
+			const auto start = steady_clock::now();
+			Measure(forceFields, [&] { simulation.ApplyForceFields(); });
+			Measure(simulate, [&] { scene.simulate(timeStep); });
+			Measure(fetchResults, [&] { scene.fetchResults(true); });
+			seconds += duration<double>(steady_clock::now() - start).count();
+
+			if (poseWriter) {
+				CapturePoses(simulationDesc, poses);
+				poseWriter->Write(poses);
+			}
+		}
+
+		const auto& [ThreadCount, QueueDepth, MaxQueueDepth, SubmittedCount, ExecutedCount, StolenCount] = TaskScheduler::Get().GetStatistics();
+
+		const nlohmann::ordered_json report{
+			{ "Frames", options.FrameCount },
+			{ "TimeStep", options.TimeStep },
+			{ "Oscillators", options.OscillatorCount },
+			{ "Bodies", size(simulationDesc.Objects) },
+			{ "Seed", options.Seed },
+			{ "ThreadCount", ThreadCount },
+			{ "PhysXWorkerCount", scene.getCpuDispatcher()->getWorkerCount() },
+			{ "ForceFields", {
+				{ "EarthGravity", options.IsEarthGravityEnabled },
+				{ "StarGravity", options.IsStarGravityEnabled },
+				{ "MutualGravitation", options.IsMutualGravitationEnabled }
+			} },
+			{ "Seconds", seconds },
+			{ "StepsPerSecond", seconds > 0 ? static_cast<double>(options.FrameCount) / seconds : 0 },
+			{ "Phases", {
+				{ "ForceFields", forceFields.ToJSON(options.FrameCount) },
+				{ "Simulate", simulate.ToJSON(options.FrameCount) },
+				{ "FetchResults", fetchResults.ToJSON(options.FrameCount) }
+			} },
+			{ "Tasks", {
+				{ "Submitted", SubmittedCount },
+				{ "Executed", ExecutedCount },
+				{ "Stolen", StolenCount },
+				{ "MaxQueueDepth", MaxQueueDepth }
+			} },
+			{ "PoseChecksum", format("{:016x}", CalculatePoseChecksum(simulationDesc)) }
+		};
+
+		if (empty(options.OutputPath)) {
+			cout << setw(4) << report << endl;
+		}
+		else {
+			ofstream(options.OutputPath, ios_base::trunc) << setw(4) << report << endl;
+		}
+
+		return EXIT_SUCCESS;
+	}
+	catch (const exception& e) {
+		println(cerr, "{}", e.what());
+	}
+	catch (...) {
+		println(cerr, "Unknown exception");
+	}
+
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,241 @@
+module;
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "PhysX.h"
+
+export module PoseStream;
+
+import ErrorHelpers;
+
+using namespace ErrorHelpers;
+using namespace physx;
+using namespace std;
+using namespace std::filesystem;
+
+namespace {
+	constexpr uint32_t Magic = 0x45534f50, Version = 1;
+
+	constexpr size_t ValueCount = 7;
+
+	constexpr float RotationScale = 32767;
+
+	struct Header {
+		uint32_t Magic = ::Magic, Version = ::Version;
+		uint32_t ObjectCount{}, KeyframeInterval{};
+		double TimeStep{};
+		float PositionQuantum{};
+		uint32_t _{};
+
+		bool IsValid() const {
+			return Magic == ::Magic && Version == ::Version
+				&& KeyframeInterval && TimeStep > 0 && PositionQuantum > 0;
+		}
+	};
+
+	void Quantize(const PxTransform& pose, float positionQuantum, int32_t* values) {
+		const auto QuantizePosition = [&](float value) {
+			return static_cast<int32_t>(clamp(round(static_cast<double>(value) / positionQuantum), static_cast<double>(numeric_limits<int32_t>::min()), static_cast<double>(numeric_limits<int32_t>::max())));
+		};
+		const auto QuantizeRotation = [&](float value) { return static_cast<int32_t>(lround(clamp(value, -1.0f, 1.0f) * RotationScale)); };
+
+		const auto q = pose.q.w < 0 ? -pose.q : pose.q;
+		values[0] = QuantizePosition(pose.p.x);
+		values[1] = QuantizePosition(pose.p.y);
+		values[2] = QuantizePosition(pose.p.z);
+		values[3] = QuantizeRotation(q.x);
+		values[4] = QuantizeRotation(q.y);
+		values[5] = QuantizeRotation(q.z);
+		values[6] = QuantizeRotation(q.w);
+	}
+
+	PxTransform Dequantize(const int32_t* values, float positionQuantum) {
+		PxTransform pose(
+			PxVec3(static_cast<float>(values[0]), static_cast<float>(values[1]), static_cast<float>(values[2])) * positionQuantum,
+			PxQuat(static_cast<float>(values[3]), static_cast<float>(values[4]), static_cast<float>(values[5]), static_cast<float>(values[6]))
+		);
+		if (const auto magnitude = pose.q.magnitude(); magnitude > 0) {
+			pose.q *= 1 / magnitude;
+		}
+		else {
+			pose.q = PxQuat(PxIdentity);
+		}
+		return pose;
+	}
+
+	void WriteVarint(vector<uint8_t>& buffer, uint64_t value) {
+		while (value >= 0x80) {
+			buffer.emplace_back(static_cast<uint8_t>(value | 0x80));
+			value >>= 7;
+		}
+		buffer.emplace_back(static_cast<uint8_t>(value));
+	}
+
+	bool ReadVarint(span<const uint8_t> buffer, size_t& offset, uint64_t& value) {
+		value = 0;
+		for (uint32_t shift = 0; shift < 64 && offset < size(buffer); shift += 7) {
+			const auto byte = buffer[offset++];
+			value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+			if (!(byte & 0x80)) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	constexpr int32_t Subtract(int32_t a, int32_t b) { return static_cast<int32_t>(static_cast<uint32_t>(a) - static_cast<uint32_t>(b)); }
+
+	constexpr int32_t Add(int32_t a, int32_t b) { return static_cast<int32_t>(static_cast<uint32_t>(a) + static_cast<uint32_t>(b)); }
+
+	constexpr uint32_t EncodeZigZag(int32_t value) { return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31); }
+
+	constexpr int32_t DecodeZigZag(uint32_t value) { return static_cast<int32_t>(value >> 1) ^ -static_cast<int32_t>(value & 1); }
+}
+
+export namespace PoseStream {
+	class Writer {
+	public:
+		explicit Writer(const path& filePath, uint32_t objectCount, double timeStep, float positionQuantum = 1.0f / 4096, uint32_t keyframeInterval = 600) :
+			m_filePath(filePath),
+			m_header{ .ObjectCount = objectCount, .KeyframeInterval = keyframeInterval, .TimeStep = timeStep, .PositionQuantum = positionQuantum },
+			m_values(objectCount * ValueCount), m_previousValues(objectCount * ValueCount) {
+			if (!m_header.IsValid()) {
+				Throw<invalid_argument>("Invalid pose stream parameters");
+			}
+
+			if (m_filePath.has_parent_path()) {
+				create_directories(m_filePath.parent_path());
+			}
+
+			m_file.open(m_filePath, ios::binary | ios::trunc);
+			m_file.write(reinterpret_cast<const char*>(&m_header), sizeof(m_header));
+			if (!m_file) {
+				Throw<runtime_error>(format("{}: Failed to write pose stream", m_filePath.string()));
+			}
+		}
+
+		uint64_t GetFrameCount() const { return m_frameCount; }
+
+		void Write(span<const PxTransform> poses) {
+			if (size(poses) != m_header.ObjectCount) {
+				Throw<invalid_argument>("Pose count mismatch");
+			}
+
+			const auto isKeyframe = m_frameCount % m_header.KeyframeInterval == 0;
+			for (size_t i = 0; i < size(poses); i++) {
+				Quantize(poses[i], m_header.PositionQuantum, &m_values[i * ValueCount]);
+			}
+
+			m_buffer.clear();
+			for (size_t i = 0; i < size(m_values); i++) {
+				WriteVarint(m_buffer, EncodeZigZag(isKeyframe ? m_values[i] : Subtract(m_values[i], m_previousValues[i])));
+			}
+			swap(m_values, m_previousValues);
+
+			m_frameHeader.clear();
+			WriteVarint(m_frameHeader, size(m_buffer));
+			m_file.write(reinterpret_cast<const char*>(data(m_frameHeader)), static_cast<streamsize>(size(m_frameHeader)));
+			m_file.write(reinterpret_cast<const char*>(data(m_buffer)), static_cast<streamsize>(size(m_buffer)));
+			if (!m_file) {
+				Throw<runtime_error>(format("{}: Failed to write pose stream", m_filePath.string()));
+			}
+
+			m_frameCount++;
+		}
+
+	private:
+		path m_filePath;
+		ofstream m_file;
+		Header m_header;
+		vector<int32_t> m_values, m_previousValues;
+		vector<uint8_t> m_frameHeader, m_buffer;
+		uint64_t m_frameCount{};
+	};
+
+	class Reader {
+	public:
+		explicit Reader(const path& filePath) : m_filePath(filePath), m_file(filePath, ios::binary) {
+			m_file.read(reinterpret_cast<char*>(&m_header), sizeof(m_header));
+			if (!m_file || !m_header.IsValid()) {
+				Throw<runtime_error>(format("{}: Invalid pose stream", m_filePath.string()));
+			}
+
+			m_values.resize(m_header.ObjectCount * ValueCount);
+		}
+
+		uint32_t GetObjectCount() const { return m_header.ObjectCount; }
+
+		double GetTimeStep() const { return m_header.TimeStep; }
+
+		uint64_t GetFrameIndex() const { return m_frameIndex; }
+
+		bool Read(span<PxTransform> poses) {
+			if (size(poses) != m_header.ObjectCount) {
+				Throw<invalid_argument>("Pose count mismatch");
+			}
+
+			uint64_t frameSize = 0;
+			for (uint32_t shift = 0; ; shift += 7) {
+				const auto byte = m_file.get();
+				if (byte == char_traits<char>::eof()) {
+					if (shift) {
+						Throw<runtime_error>(format("{}: Truncated pose stream", m_filePath.string()));
+					}
+					return false;
+				}
+				frameSize |= static_cast<uint64_t>(byte & 0x7f) << shift;
+				if (!(byte & 0x80)) {
+					break;
+				}
+				if (shift >= 63) {
+					Throw<runtime_error>(format("{}: Invalid pose stream", m_filePath.string()));
+				}
+			}
+
+			m_buffer.resize(frameSize);
+			if (!m_file.read(reinterpret_cast<char*>(data(m_buffer)), static_cast<streamsize>(frameSize))) {
+				Throw<runtime_error>(format("{}: Truncated pose stream", m_filePath.string()));
+			}
+
+			const auto isKeyframe = m_frameIndex % m_header.KeyframeInterval == 0;
+			size_t offset = 0;
+			for (auto& value : m_values) {
+				uint64_t encodedValue;
+				if (!ReadVarint(m_buffer, offset, encodedValue)) {
+					Throw<runtime_error>(format("{}: Invalid pose stream", m_filePath.string()));
+				}
+				const auto delta = DecodeZigZag(static_cast<uint32_t>(encodedValue));
+				value = isKeyframe ? delta : Add(value, delta);
+			}
+
+			for (size_t i = 0; i < size(poses); i++) {
+				poses[i] = Dequantize(&m_values[i * ValueCount], m_header.PositionQuantum);
+			}
+
+			m_frameIndex++;
+
+			return true;
+		}
+
+		void Rewind() {
+			m_file.clear();
+			m_file.seekg(sizeof(m_header));
+			m_frameIndex = 0;
+		}
+
+	private:
+		path m_filePath;
+		ifstream m_file;
+		Header m_header;
+		vector<int32_t> m_values;
+		vector<uint8_t> m_buffer;
+		uint64_t m_frameIndex{};
+	};
+}
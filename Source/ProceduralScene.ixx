@@ -0,0 +1,132 @@
+module;
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+#include "directxtk12/GamePad.h"
+#include "directxtk12/Keyboard.h"
+#include "directxtk12/Mouse.h"
+#include "directxtk12/SimpleMath.h"
+
+#include "PhysX.h"
+
+export module ProceduralScene;
+
+export import Scene;
+export import SceneGenerator;
+
+import DeviceContext;
+import ForceFields;
+import PhysXCpuDispatcher;
+
+using namespace DirectX;
+using namespace DirectX::SimpleMath;
+using namespace PhysicsHelpers;
+using namespace physx;
+using namespace std;
+
+using GamepadButtonState = GamePad::ButtonStateTracker::ButtonState;
+using Key = Keyboard::Keys;
+
+namespace {
+	constexpr LPCSTR SphereURI = "Sphere";
+}
+
+export {
+	struct ProceduralSceneDesc : SceneDesc {
+		explicit ProceduralSceneDesc(const SceneGenerator::Parameters& parameters, PxReal amplitude = 0.5f, PxReal period = 3) {
+			AddGeoSphere(SphereURI, 1, 6, { .Optimize = true, .QuantizePositions = true });
+			GenerateLODs(SphereURI, 3);
+
+			Camera.Position = { 0, parameters.Height + 2, -0.5f * parameters.CellSize * static_cast<float>(parameters.GridSize) - 2 };
+
+			EnvironmentLight.Rotation = Quaternion::CreateFromYawPitchRoll(XM_PI, 0, 0);
+			EnvironmentLight.Texture = L"Assets/Textures/141_hdrmaps_com_free.exr";
+
+			PhysX = make_shared<::PhysX>(make_unique<PhysXCpuDispatcher>());
+
+			auto& physics = PhysX->GetPhysics();
+
+			const auto& material = *physics.createMaterial(0.5f, 0.5f, 0.6f);
+
+			const auto objects = SceneGenerator::Generate(parameters);
+
+			const auto omega = PxTwoPi / period;
+
+			vector<PxActor*> actors;
+			actors.reserve(size(objects));
+			RenderObjects.reserve(size(objects));
+			for (const auto& [Sphere, Material] : objects) {
+				auto position = Sphere.Center;
+				position.y += SimpleHarmonicMotion::Spring::CalculateDisplacement(amplitude, omega, 0.0f, position.x);
+
+				auto& rigidDynamic = *physics.createRigidDynamic(PxTransform(position));
+
+				RenderObjectDesc renderObject;
+
+				renderObject.MeshURI = SphereURI;
+				renderObject.Material = Material;
+				renderObject.Shape = PxRigidActorExt::createExclusiveShape(rigidDynamic, PxSphereGeometry(Sphere.Radius), material);
+
+				PxRigidBodyExt::updateMassAndInertia(rigidDynamic, 1);
+				rigidDynamic.setAngularDamping(0);
+				rigidDynamic.setLinearVelocity({ 0, SimpleHarmonicMotion::Spring::CalculateVelocity(amplitude, omega, 0.0f, position.x), 0 });
+
+				actors.emplace_back(&rigidDynamic);
+
+				RenderObjects.emplace_back(move(renderObject));
+			}
+			PhysX->GetScene().addActors(data(actors), static_cast<PxU32>(size(actors)));
+		}
+	};
+
+	struct ProceduralScene : Scene {
+		ProceduralScene(const DeviceContext& deviceContext, PxReal height = 0.5f, PxReal period = 3) : Scene(deviceContext), m_height(height), m_period(period) {}
+
+		~ProceduralScene() override { StopSimulation(); }
+
+		bool IsStatic() const override { return !m_isPhysXRunning; }
+
+		void Tick([[maybe_unused]] double elapsedSeconds, const GamePad::ButtonStateTracker& gamepadStateTracker, const Keyboard::KeyboardStateTracker& keyboardStateTracker, const Mouse::ButtonStateTracker& mouseStateTracker) override {
+			if (mouseStateTracker.GetLastState().positionMode == Mouse::MODE_RELATIVE) {
+				if (gamepadStateTracker.a == GamepadButtonState::PRESSED) {
+					m_isPhysXRunning = !m_isPhysXRunning;
+				}
+				if (keyboardStateTracker.IsKeyPressed(Key::Space)) {
+					m_isPhysXRunning = !m_isPhysXRunning;
+				}
+			}
+
+			if (IsStatic()) {
+				return;
+			}
+
+			Refresh();
+		}
+
+	protected:
+		void Tick(double elapsedSeconds) override {
+			if (!m_forceFieldSystem.GetBodyCount()) {
+				m_forceFieldSystem.Clear();
+				const auto spring = m_forceFieldSystem.Add(SpringField{ m_height, m_period });
+				for (const auto& renderObject : RenderObjects) {
+					if (const auto rigidBody = renderObject.Shape->getActor()->is<PxRigidBody>()) {
+						m_forceFieldSystem.AddBody(*rigidBody, spring);
+					}
+				}
+			}
+
+			m_forceFieldSystem.Apply();
+
+			PhysX->Tick(static_cast<float>(min(1.0 / 60, elapsedSeconds)));
+		}
+
+	private:
+		PxReal m_height, m_period;
+
+		atomic_bool m_isPhysXRunning = true;
+
+		ForceFieldSystem m_forceFieldSystem;
+	};
+}
@@ -32,7 +32,7 @@ using namespace rtxdi;
 using namespace std;
 
 export struct RTXDI {
-	struct { GPUBuffer* Camera, * ObjectData; } GPUBuffers{};
+	struct { GPUBuffer* Camera, * ObjectData, * MeshData, * MaterialData; } GPUBuffers{};
 
 	struct {
 		Texture
@@ -144,6 +144,8 @@ export struct RTXDI {
 		commandList.SetState(*m_GPUBuffers.GraphicsSettings, D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER);
 		commandList.SetState(*GPUBuffers.Camera, D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER);
 		commandList.SetState(*GPUBuffers.ObjectData, D3D12_RESOURCE_STATE_ALL_SHADER_RESOURCE);
+		commandList.SetState(*GPUBuffers.MeshData, D3D12_RESOURCE_STATE_ALL_SHADER_RESOURCE);
+		commandList.SetState(*GPUBuffers.MaterialData, D3D12_RESOURCE_STATE_ALL_SHADER_RESOURCE);
 		commandList.SetState(*m_resources->LightInfo, D3D12_RESOURCE_STATE_ALL_SHADER_RESOURCE);
 		commandList.SetState(*m_resources->LightIndices, D3D12_RESOURCE_STATE_ALL_SHADER_RESOURCE);
 		commandList.SetState(*m_resources->LocalLightPDF, D3D12_RESOURCE_STATE_ALL_SHADER_RESOURCE);
@@ -169,6 +171,8 @@ export struct RTXDI {
 		commandList->SetComputeRootConstantBufferView(i++, m_GPUBuffers.GraphicsSettings->GetNative()->GetGPUVirtualAddress());
 		commandList->SetComputeRootConstantBufferView(i++, GPUBuffers.Camera->GetNative()->GetGPUVirtualAddress());
 		commandList->SetComputeRootShaderResourceView(i++, GPUBuffers.ObjectData->GetNative()->GetGPUVirtualAddress());
+		commandList->SetComputeRootShaderResourceView(i++, GPUBuffers.MeshData->GetNative()->GetGPUVirtualAddress());
+		commandList->SetComputeRootShaderResourceView(i++, GPUBuffers.MaterialData->GetNative()->GetGPUVirtualAddress());
 		commandList->SetComputeRootShaderResourceView(i++, m_resources->LightInfo->GetNative()->GetGPUVirtualAddress());
 		commandList->SetComputeRootShaderResourceView(i++, m_resources->LightIndices->GetNative()->GetGPUVirtualAddress());
 		commandList->SetComputeRootDescriptorTable(i++, m_resources->NeighborOffsets->GetSRVDescriptor(BufferSRVType::Typed));
@@ -41,7 +41,7 @@ export struct Raytracing {
 		uint32_t IsHashGridVisualizationEnabled;
 	};
 
-	struct { GPUBuffer* SceneData, * Camera, * ObjectData; } GPUBuffers{};
+	struct { GPUBuffer* SceneData, * Camera, * ObjectData, * MeshData, * MaterialData; } GPUBuffers{};
 
 	struct {
 		Texture
@@ -184,6 +184,8 @@ private:
 		commandList.SetState(*GPUBuffers.SceneData, D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER);
 		commandList.SetState(*GPUBuffers.Camera, D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER);
 		commandList.SetState(*GPUBuffers.ObjectData, D3D12_RESOURCE_STATE_ALL_SHADER_RESOURCE);
+		commandList.SetState(*GPUBuffers.MeshData, D3D12_RESOURCE_STATE_ALL_SHADER_RESOURCE);
+		commandList.SetState(*GPUBuffers.MaterialData, D3D12_RESOURCE_STATE_ALL_SHADER_RESOURCE);
 		commandList.SetState(*Textures.Position, D3D12_RESOURCE_STATE_ALL_SHADER_RESOURCE);
 		commandList.SetState(*Textures.FlatNormal, D3D12_RESOURCE_STATE_ALL_SHADER_RESOURCE);
 		commandList.SetState(*Textures.GeometricNormal, D3D12_RESOURCE_STATE_ALL_SHADER_RESOURCE);
@@ -199,6 +201,8 @@ private:
 		commandList->SetComputeRootConstantBufferView(i++, GPUBuffers.SceneData->GetNative()->GetGPUVirtualAddress());
 		commandList->SetComputeRootConstantBufferView(i++, GPUBuffers.Camera->GetNative()->GetGPUVirtualAddress());
 		commandList->SetComputeRootShaderResourceView(i++, GPUBuffers.ObjectData->GetNative()->GetGPUVirtualAddress());
+		commandList->SetComputeRootShaderResourceView(i++, GPUBuffers.MeshData->GetNative()->GetGPUVirtualAddress());
+		commandList->SetComputeRootShaderResourceView(i++, GPUBuffers.MaterialData->GetNative()->GetGPUVirtualAddress());
 		commandList->SetComputeRootDescriptorTable(i++, Textures.Position->GetSRVDescriptor());
 		commandList->SetComputeRootDescriptorTable(i++, Textures.FlatNormal->GetSRVDescriptor());
 		commandList->SetComputeRootDescriptorTable(i++, Textures.GeometricNormal->GetSRVDescriptor());
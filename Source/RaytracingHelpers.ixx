@@ -25,12 +25,42 @@ export namespace DirectX::RaytracingHelpers {
 		shared_ptr<GPUBuffer> InstanceDescs;
 	};
 
+	class RefitPolicy {
+	public:
+		struct Statistics { uint64_t RebuildCount, RefitCount; };
+
+		uint32_t MaxRefitCount = 120;
+		float MaxAccumulatedMotion = 1;
+
+		bool ShouldRefit(bool isInstanceSetChanged, float motion) {
+			m_accumulatedMotion += motion;
+			if (!isInstanceSetChanged && m_refitCount < MaxRefitCount && m_accumulatedMotion <= MaxAccumulatedMotion) {
+				m_refitCount++;
+				m_statistics.RefitCount++;
+				return true;
+			}
+			m_refitCount = 0;
+			m_accumulatedMotion = 0;
+			m_statistics.RebuildCount++;
+			return false;
+		}
+
+		const Statistics& GetStatistics() const noexcept { return m_statistics; }
+
+	private:
+		uint32_t m_refitCount{};
+		float m_accumulatedMotion{};
+
+		Statistics m_statistics{};
+	};
+
 	void BuildTopLevelAccelerationStructure(
 		CommandList& commandList,
 		D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAGS flags,
-		span<const D3D12_RAYTRACING_INSTANCE_DESC> descs,
+		UINT instanceCount,
 		bool resize,
-		TopLevelAccelerationStructure& accelerationStructure
+		TopLevelAccelerationStructure& accelerationStructure,
+		bool refit = true
 	) {
 		const auto& deviceContext = commandList.GetDeviceContext();
 
@@ -39,32 +69,22 @@ export namespace DirectX::RaytracingHelpers {
 		D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_INPUTS inputs{
 			.Type = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL,
 			.Flags = flags,
-			.NumDescs = static_cast<UINT>(size(descs))
+			.NumDescs = instanceCount
 		};
 
-		if (!resize && (flags & D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_ALLOW_UPDATE) && isValid) {
+		if (refit && !resize && (flags & D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_ALLOW_UPDATE) && isValid) {
 			inputs.Flags |= D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_PERFORM_UPDATE;
 		}
-		else {
-			if (inputs.NumDescs) {
-				if (resize
-					|| !accelerationStructure.InstanceDescs || accelerationStructure.InstanceDescs->GetCapacity() < inputs.NumDescs) {
-					accelerationStructure.InstanceDescs = GPUBuffer::CreateDefault<D3D12_RAYTRACING_INSTANCE_DESC>(deviceContext, inputs.NumDescs);
-				}
-			}
-			else if (resize && accelerationStructure.InstanceDescs) {
-				accelerationStructure.InstanceDescs.reset();
-			}
-		}
 
 		if (inputs.NumDescs) {
-			commandList.Copy(*accelerationStructure.InstanceDescs, descs);
-			commandList.SetState(*accelerationStructure.InstanceDescs, D3D12_RESOURCE_STATE_ALL_SHADER_RESOURCE);
+			if (!accelerationStructure.InstanceDescs->IsMappable()) {
+				commandList.SetState(*accelerationStructure.InstanceDescs, D3D12_RESOURCE_STATE_ALL_SHADER_RESOURCE);
+			}
 			inputs.InstanceDescs = accelerationStructure.InstanceDescs->GetNative()->GetGPUVirtualAddress();
 		}
 
 		if (isValid) {
-			if (!resize) {
+			if (refit && !resize) {
 				commandList.UpdateAccelerationStructures(initializer_list{ inputs }, { accelerationStructure.ID });
 				return;
 			}
@@ -73,14 +93,50 @@ export namespace DirectX::RaytracingHelpers {
 		accelerationStructure.ID = commandList.BuildAccelerationStructures(initializer_list{ inputs })[0];
 	}
 
+	void BuildTopLevelAccelerationStructure(
+		CommandList& commandList,
+		D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAGS flags,
+		span<const D3D12_RAYTRACING_INSTANCE_DESC> descs,
+		bool resize,
+		TopLevelAccelerationStructure& accelerationStructure
+	) {
+		const auto& deviceContext = commandList.GetDeviceContext();
+
+		const auto instanceCount = static_cast<UINT>(size(descs));
+
+		if (resize || !(flags & D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_ALLOW_UPDATE) || !deviceContext.AccelerationStructureManager->IsValid(accelerationStructure.ID)) {
+			if (instanceCount) {
+				if (resize
+					|| !accelerationStructure.InstanceDescs || accelerationStructure.InstanceDescs->GetCapacity() < instanceCount) {
+					accelerationStructure.InstanceDescs = GPUBuffer::CreateDefault<D3D12_RAYTRACING_INSTANCE_DESC>(deviceContext, instanceCount);
+				}
+			}
+			else if (resize && accelerationStructure.InstanceDescs) {
+				accelerationStructure.InstanceDescs.reset();
+			}
+		}
+
+		if (instanceCount) {
+			commandList.Copy(*accelerationStructure.InstanceDescs, descs);
+		}
+
+		BuildTopLevelAccelerationStructure(commandList, flags, instanceCount, resize, accelerationStructure);
+	}
+
 	D3D12_RAYTRACING_GEOMETRY_DESC CreateGeometryDesc(
 		const GPUBuffer& vertices, const GPUBuffer& indices,
 		D3D12_RAYTRACING_GEOMETRY_FLAGS flags = D3D12_RAYTRACING_GEOMETRY_FLAG_NONE,
 		D3D12_GPU_VIRTUAL_ADDRESS transform3x4 = NULL,
 		DXGI_FORMAT vertexFormat = DXGI_FORMAT_R32G32B32_FLOAT
 	) {
-		const auto indexStride = indices.GetStride();
-		if (indexStride != sizeof(uint16_t) && indexStride != sizeof(uint32_t)) {
+		auto indexFormat = indices.GetFormat();
+		if (indexFormat == DXGI_FORMAT_UNKNOWN) {
+			switch (indices.GetStride()) {
+				case sizeof(uint16_t): indexFormat = DXGI_FORMAT_R16_UINT; break;
+				case sizeof(uint32_t): indexFormat = DXGI_FORMAT_R32_UINT; break;
+			}
+		}
+		if (indexFormat != DXGI_FORMAT_R16_UINT && indexFormat != DXGI_FORMAT_R32_UINT) {
 			Throw<invalid_argument>("Triangle index format must be either uint16 or uint32");
 		}
 		const auto indexCount = indices.GetCapacity();
@@ -91,7 +147,7 @@ export namespace DirectX::RaytracingHelpers {
 			.Flags = flags,
 			.Triangles{
 				.Transform3x4 = transform3x4,
-				.IndexFormat = indexStride == sizeof(uint16_t) ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT,
+				.IndexFormat = indexFormat,
 				.VertexFormat = vertexFormat,
 				.IndexCount = static_cast<UINT>(indexCount),
 				.VertexCount = static_cast<UINT>(vertices.GetCapacity()),
@@ -1,36 +1,56 @@
 module;
 
+#include <atomic>
+#include <chrono>
 #include <filesystem>
+#include <format>
+#include <optional>
+#include <thread>
 
 #include "directxtk12/GamePad.h"
+#include "directxtk12/GeometricPrimitive.h"
 #include "directxtk12/Keyboard.h"
 #include "directxtk12/Mouse.h"
 #include "directxtk12/SimpleMath.h"
 
 #include "rtxmu/D3D12AccelStructManager.h"
 
+#include "DirectXMesh.h"
+
 #include "PhysX.h"
 
 export module Scene;
 
 import CommandList;
 import DeviceContext;
+import ErrorHelpers;
+import GPUBuffer;
 import Math;
 import Material;
+import MeshCache;
+import MeshHelpers;
+import MeshRegistry;
 import Model;
+import PoseStream;
 import RaytracingHelpers;
 import ResourceHelpers;
 import TextureHelpers;
+import ThreadHelpers;
+import TransformHelpers;
 
 using namespace DirectX;
 using namespace DirectX::RaytracingHelpers;
 using namespace DirectX::SimpleMath;
+using namespace ErrorHelpers;
 using namespace Math;
 using namespace physx;
 using namespace ResourceHelpers;
 using namespace std;
+using namespace std::chrono;
 using namespace std::filesystem;
 using namespace TextureHelpers;
+using namespace ThreadHelpers;
+using namespace TransformHelpers;
 
 export {
 	struct RenderObjectBase {
@@ -52,6 +72,14 @@ export {
 	struct RenderObject : RenderObjectBase {
 		shared_ptr<Mesh> Mesh;
 
+		struct LOD {
+			shared_ptr<::Mesh> Mesh;
+			float Error;
+		};
+		vector<LOD> LODs;
+
+		uint32_t Generation{};
+
 		shared_ptr<Texture> Textures[to_underlying(TextureMapType::Count)];
 	};
 
@@ -73,14 +101,161 @@ export {
 		virtual ~SceneBase() = default;
 	};
 
+	struct MeshDesc {
+		string CacheKey;
+		path CacheFilePath;
+
+		Mesh::CreationOptions CreationOptions{};
+
+		float LODError{};
+
+		optional<MeshHelpers::OptimizationReport> OptimizationReport;
+
+		shared_ptr<vector<Mesh::VertexType>> Vertices;
+		shared_ptr<vector<Mesh::IndexType>> Indices;
+	};
+
 	struct SceneDesc : SceneBase {
 		struct : EnvironmentLightBase {
 			path Texture;
 		} EnvironmentLight;
 
-		unordered_map<string, pair<shared_ptr<vector<Mesh::VertexType>>, shared_ptr<vector<Mesh::IndexType>>>> Meshes;
+		unordered_map<string, MeshDesc> Meshes;
 
 		vector<RenderObjectDesc> RenderObjects;
+
+		static string GetLODURI(string_view URI, size_t level) { return format("{}#LOD{}", URI, level); }
+
+		void AddGeoSphere(const string& URI, float diameter, size_t tessellation, const Mesh::CreationOptions& creationOptions = {}) {
+			auto& meshDesc = Meshes[URI];
+			meshDesc.CacheKey = format("GeoSphere:{}:{}:{}", diameter, tessellation, creationOptions.Optimize);
+			meshDesc.CreationOptions = { .QuantizePositions = creationOptions.QuantizePositions };
+			const auto cacheFilePath = MeshCache::GetFilePath(meshDesc.CacheKey);
+			if (const auto info = MeshCache::GetInfo(cacheFilePath, meshDesc.CacheKey)) {
+				meshDesc.CacheFilePath = cacheFilePath;
+				meshDesc.OptimizationReport = info->Metadata.OptimizationReport;
+			}
+			else {
+				GeometricPrimitive::VertexCollection vertices;
+				GeometricPrimitive::IndexCollection indices;
+				GeometricPrimitive::CreateGeoSphere(vertices, indices, diameter, tessellation);
+				ranges::reverse(indices);
+
+				const auto vertexCount = size(vertices);
+				vector<XMFLOAT3> positions, normals, tangents(vertexCount);
+				vector<XMFLOAT2> textureCoordinates;
+				positions.reserve(vertexCount);
+				normals.reserve(vertexCount);
+				textureCoordinates.reserve(vertexCount);
+				for (const auto& vertex : vertices) {
+					positions.emplace_back(vertex.position);
+					normals.emplace_back(vertex.normal);
+					textureCoordinates.emplace_back(vertex.textureCoordinate);
+				}
+				ThrowIfFailed(ComputeTangentFrame(
+					data(indices), size(indices) / 3,
+					data(positions), data(normals), data(textureCoordinates), vertexCount,
+					data(tangents), nullptr
+				));
+
+				meshDesc.Vertices = make_shared<vector<Mesh::VertexType>>();
+				meshDesc.Vertices->reserve(vertexCount);
+				for (size_t i = 0; i < vertexCount; i++) {
+					Mesh::VertexType vertex;
+					vertex.Position = positions[i];
+					vertex.StoreNormal(normals[i]);
+					vertex.StoreTangent(tangents[i]);
+					vertex.StoreTextureCoordinate(textureCoordinates[i], 0);
+					meshDesc.Vertices->emplace_back(vertex);
+				}
+				meshDesc.Indices = make_shared<vector<Mesh::IndexType>>(cbegin(indices), cend(indices));
+
+				if (creationOptions.Optimize) {
+					meshDesc.OptimizationReport = MeshHelpers::Optimize(*meshDesc.Vertices, *meshDesc.Indices);
+				}
+
+				try {
+					MeshCache::Save(cacheFilePath, meshDesc.CacheKey, *meshDesc.Vertices, *meshDesc.Indices, { .OptimizationReport = meshDesc.OptimizationReport }, true);
+				}
+				catch (...) {}
+			}
+		}
+
+		void GenerateLODs(const string& URI, size_t levelCount, float reduction = 0.5f, float maxError = 0.01f) {
+			const auto& meshDesc = Meshes.at(URI);
+
+			vector<Mesh::VertexType> vertices;
+			vector<Mesh::IndexType> indices;
+			const MeshDesc* pSourceMeshDesc = &meshDesc;
+			auto isSourceLoaded = false;
+
+			auto error = meshDesc.LODError;
+			for (size_t level = 1; level <= levelCount; level++) {
+				const auto cacheKey = format("{}#LOD{}:{}:{}", meshDesc.CacheKey, level, reduction, maxError);
+				const auto cacheFilePath = MeshCache::GetFilePath(cacheKey);
+				if (const auto info = MeshCache::GetInfo(cacheFilePath, cacheKey)) {
+					if (!info->IndexCount) {
+						break;
+					}
+
+					auto& LODMeshDesc = Meshes[GetLODURI(URI, level)];
+					LODMeshDesc.CacheKey = cacheKey;
+					LODMeshDesc.CacheFilePath = cacheFilePath;
+					LODMeshDesc.CreationOptions = meshDesc.CreationOptions;
+					LODMeshDesc.LODError = error = info->Metadata.LODError;
+					LODMeshDesc.OptimizationReport = info->Metadata.OptimizationReport;
+					pSourceMeshDesc = &LODMeshDesc;
+					isSourceLoaded = false;
+					continue;
+				}
+
+				if (!isSourceLoaded) {
+					if (empty(pSourceMeshDesc->CacheFilePath)) {
+						vertices = *pSourceMeshDesc->Vertices;
+						indices = *pSourceMeshDesc->Indices;
+					}
+					else {
+						const MeshCache::MappedMesh mappedMesh(pSourceMeshDesc->CacheFilePath, pSourceMeshDesc->CacheKey);
+						vertices.assign(cbegin(mappedMesh.GetVertices()), cend(mappedMesh.GetVertices()));
+						visit([&](auto indices1) { indices.assign(cbegin(indices1), cend(indices1)); }, mappedMesh.GetIndices());
+					}
+					isSourceLoaded = true;
+				}
+
+				const auto indexCount = size(indices);
+				error += MeshHelpers::Simplify(vertices, indices, static_cast<size_t>(static_cast<float>(indexCount / 3) * reduction) * 3, maxError);
+				const auto isSimplified = size(indices) != indexCount;
+
+				optional<MeshHelpers::OptimizationReport> optimizationReport;
+				if (isSimplified && meshDesc.OptimizationReport) {
+					optimizationReport = MeshHelpers::Optimize(vertices, indices);
+				}
+
+				try {
+					MeshCache::Save(
+						cacheFilePath, cacheKey,
+						isSimplified ? span<const Mesh::VertexType>(vertices) : span<const Mesh::VertexType>(),
+						isSimplified ? span<const Mesh::IndexType>(indices) : span<const Mesh::IndexType>(),
+						{ .LODError = error, .OptimizationReport = optimizationReport },
+						true
+					);
+				}
+				catch (...) {}
+
+				if (!isSimplified) {
+					break;
+				}
+
+				auto& LODMeshDesc = Meshes[GetLODURI(URI, level)];
+				LODMeshDesc.CacheKey = cacheKey;
+				LODMeshDesc.CreationOptions = meshDesc.CreationOptions;
+				LODMeshDesc.LODError = error;
+				LODMeshDesc.OptimizationReport = optimizationReport;
+				LODMeshDesc.Vertices = make_shared<vector<Mesh::VertexType>>(vertices);
+				LODMeshDesc.Indices = make_shared<vector<Mesh::IndexType>>(indices);
+				pSourceMeshDesc = &LODMeshDesc;
+			}
+		}
 	};
 
 	struct Scene : SceneBase {
@@ -94,23 +269,30 @@ export {
 		} EnvironmentLight;
 
 		unordered_map<string, shared_ptr<Mesh>> Meshes;
+		unordered_map<string, MeshCache::Metadata> MeshMetadata;
 
 		vector<RenderObject> RenderObjects;
 
-		explicit Scene(const DeviceContext& deviceContext) : m_deviceContext(deviceContext) {}
+		static constexpr duration<double> SimulationTimeStep{ 1.0 / 60 }, MaxElapsedTime{ 0.25 };
+
+		enum class PoseStreamMode { None, Record, Replay };
+
+		explicit Scene(const DeviceContext& deviceContext) : m_deviceContext(deviceContext), m_textureResidencyManager(deviceContext) {}
 
 		~Scene() override {
+			StopSimulation();
+
 			vector<uint64_t> IDs;
-			IDs.reserve(size(m_bottomLevelAccelerationStructureIDs) + 1);
-			for (const auto& [MeshNode, ID] : m_bottomLevelAccelerationStructureIDs) {
-				IDs.emplace_back(ID.first);
-				MeshNode->OnDestroyed.remove(ID.second);
+			IDs.reserve(size(m_bottomLevelAccelerationStructures) + 1);
+			for (const auto& [MeshNode, accelerationStructure] : m_bottomLevelAccelerationStructures) {
+				IDs.emplace_back(accelerationStructure.ID);
+				MeshNode->OnDestroyed.remove(accelerationStructure.OnMeshDestroyed);
 			}
 			if (m_topLevelAccelerationStructure.ID != ~0ull) {
 				IDs.emplace_back(m_topLevelAccelerationStructure.ID);
 			}
 			m_deviceContext.AccelerationStructureManager->RemoveAccelerationStructures(IDs);
-			m_bottomLevelAccelerationStructureIDs = {};
+			m_bottomLevelAccelerationStructures = {};
 			m_topLevelAccelerationStructure = {};
 
 			CollectGarbage();
@@ -118,6 +300,11 @@ export {
 
 		virtual bool IsStatic() const { return false; }
 
+		void SetPoseStream(PoseStreamMode mode, const path& filePath = {}) {
+			m_poseStreamMode = mode;
+			m_poseStreamFilePath = filePath;
+		}
+
 		virtual void Tick(double elapsedSeconds, const GamePad::ButtonStateTracker& gamepadStateTracker, const Keyboard::KeyboardStateTracker& keyboardStateTracker, const Mouse::ButtonStateTracker& mouseStateTracker) = 0;
 
 		void Load(const SceneDesc& sceneDesc) {
@@ -128,21 +315,54 @@ export {
 
 			reinterpret_cast<EnvironmentLightBase&>(EnvironmentLight) = sceneDesc.EnvironmentLight;
 			if (!empty(sceneDesc.EnvironmentLight.Texture)) {
-				EnvironmentLight.Texture = LoadTexture(commandList, ResolveResourcePath(sceneDesc.EnvironmentLight.Texture), true);
+				const TextureCache::Request request{ ResolveResourcePath(sceneDesc.EnvironmentLight.Texture), true };
+				EnvironmentLight.Texture = move(m_textureCache.Load(commandList, span(&request, 1))[0]);
 				EnvironmentLight.Texture->CreateSRV();
 			}
 
+			vector<TextureCache::Request> textureRequests;
+			vector<shared_ptr<Texture>*> textureSlots;
+
 			{
-				for (const auto& [URI, Mesh] : sceneDesc.Meshes) {
-					Meshes[URI] = Mesh::Create(*Mesh.first, *Mesh.second, m_deviceContext, commandList);
+				vector<shared_ptr<const void>> meshSources;
+				const auto CreateMesh = [&]<typename T>(const shared_ptr<const void>& source, span<const Mesh::VertexType> vertices, span<const T> indices, const Mesh::CreationOptions& options) {
+					meshSources.emplace_back(source);
+					return m_meshRegistry.Register(source, vertices, indices, options, [&] { return Mesh::Create(vertices, indices, m_deviceContext, commandList, options); });
+				};
+				for (const auto& [URI, meshDesc] : sceneDesc.Meshes) {
+					if (empty(meshDesc.CacheFilePath)) {
+						Meshes[URI] = CreateMesh(make_shared<const MeshDesc>(meshDesc), span<const Mesh::VertexType>(*meshDesc.Vertices), span<const Mesh::IndexType>(*meshDesc.Indices), meshDesc.CreationOptions);
+					}
+					else {
+						const auto mappedMesh = make_shared<const MeshCache::MappedMesh>(meshDesc.CacheFilePath, meshDesc.CacheKey);
+						Meshes[URI] = visit([&](auto indices) { return CreateMesh(mappedMesh, mappedMesh->GetVertices(), indices, meshDesc.CreationOptions); }, mappedMesh->GetIndices());
+					}
+					MeshMetadata[URI] = {
+						.LODError = meshDesc.LODError,
+						.OptimizationReport = meshDesc.OptimizationReport ? meshDesc.OptimizationReport : Meshes[URI]->OptimizationReport
+					};
 				}
 
+				RenderObjects.reserve(size(RenderObjects) + size(sceneDesc.RenderObjects));
 				for (const auto& renderObjectDesc : sceneDesc.RenderObjects) {
-					RenderObject renderObject;
+					auto& renderObject = RenderObjects.emplace_back();
 					reinterpret_cast<RenderObjectBase&>(renderObject) = renderObjectDesc;
 
 					renderObject.Mesh = Meshes.at(renderObjectDesc.MeshURI);
 
+					renderObject.LODs.emplace_back(renderObject.Mesh, MeshMetadata.at(renderObjectDesc.MeshURI).LODError);
+					if (const auto& emissiveColor = renderObject.Material.EmissiveColor;
+						max({ emissiveColor.x, emissiveColor.y, emissiveColor.z }) <= 0) {
+						for (size_t level = 1; ; level++) {
+							const auto LODURI = SceneDesc::GetLODURI(renderObjectDesc.MeshURI, level);
+							const auto pMesh = Meshes.find(LODURI);
+							if (pMesh == cend(Meshes)) {
+								break;
+							}
+							renderObject.LODs.emplace_back(pMesh->second, MeshMetadata.at(LODURI).LODError);
+						}
+					}
+
 					for (const auto textureMapType : {
 						TextureMapType::BaseColor,
 						TextureMapType::EmissiveColor,
@@ -153,17 +373,53 @@ export {
 						}) {
 						const auto i = to_underlying(textureMapType);
 						if (const auto& filePath = renderObjectDesc.Textures[i]; !empty(filePath)) {
-							auto& texture = renderObject.Textures[i];
-							texture = LoadTexture(commandList, ResolveResourcePath(filePath), textureMapType == TextureMapType::BaseColor || textureMapType == TextureMapType::EmissiveColor);
-							texture->CreateSRV();
+							const auto isColor = textureMapType == TextureMapType::BaseColor || textureMapType == TextureMapType::EmissiveColor;
+							textureRequests.emplace_back(
+								ResolveResourcePath(filePath), isColor,
+								isColor ? TextureCompression::Color : textureMapType == TextureMapType::Normal ? TextureCompression::NormalMap : TextureCompression::SingleChannel
+							);
+							textureSlots.emplace_back(&renderObject.Textures[i]);
 						}
 					}
+				}
+			}
+
+			for (size_t i = 0; auto& texture : m_textureCache.Load(commandList, textureRequests, &m_textureResidencyManager)) {
+				texture->CreateSRV();
+				*textureSlots[i++] = move(texture);
+			}
 
-					RenderObjects.emplace_back(renderObject);
+			if (m_poseStreamMode == PoseStreamMode::Replay) {
+				m_poseReader = make_unique<PoseStream::Reader>(m_poseStreamFilePath);
+				if (m_poseReader->GetObjectCount() != size(RenderObjects)) {
+					Throw<runtime_error>(format("{}: Pose stream does not match scene", m_poseStreamFilePath.string()));
 				}
+
+				auto& [Time, Poses] = m_poseSnapshots.GetFront();
+				Time = steady_clock::now();
+				ReplayPoses(Poses);
+				m_previousPoseSnapshot = {};
 			}
+			else {
+				Tick(0);
 
-			Tick(0);
+				if (m_poseStreamMode == PoseStreamMode::Record) {
+					m_poseWriter = make_unique<PoseStream::Writer>(m_poseStreamFilePath, static_cast<uint32_t>(size(RenderObjects)), SimulationTimeStep.count());
+					RecordPoses();
+				}
+			}
+
+			m_radii.resize(size(RenderObjects));
+			for (size_t i = 0; i < size(RenderObjects); i++) {
+				switch (const PxGeometryHolder geometry = RenderObjects[i].Shape->getGeometry(); geometry.getType()) {
+					case PxGeometryType::eSPHERE: m_radii[i] = geometry.sphere().radius; break;
+					default: throw;
+				}
+			}
+
+			if (!m_poseReader) {
+				PublishPoseSnapshot(steady_clock::now());
+			}
 
 			Refresh();
 
@@ -176,46 +432,146 @@ export {
 			commandList.CompactAccelerationStructures();
 
 			commandList.End();
+
+			if (!m_poseReader) {
+				StartSimulation();
+			}
 		}
 
+		const auto& GetMeshRegistryStatistics() const noexcept { return m_meshRegistry.GetStatistics(); }
+
+		const auto& GetTextureCacheStatistics() const noexcept { return m_textureCache.GetStatistics(); }
+
+		auto& GetTextureResidencyManager() noexcept { return m_textureResidencyManager; }
+
+		const auto& GetRefitPolicyStatistics() const noexcept { return m_refitPolicy.GetStatistics(); }
+
 		const auto& GetInstanceData() const noexcept { return m_instanceData; }
 
+		const auto& GetDirtyInstanceFlags() const noexcept { return m_dirtyInstanceFlags; }
+
+		void ClearDirtyInstanceFlags() { ranges::fill(m_dirtyInstanceFlags, false); }
+
 		auto GetObjectCount() const noexcept { return m_objectCount; }
 
-		void Refresh() {
-			uint32_t instanceIndex = 0, objectIndex = 0;
-			for (const auto& renderObject : RenderObjects) {
-				const auto Transform = [&] {
-					const auto& shape = *renderObject.Shape;
-
-					PxVec3 scaling;
-					switch (const PxGeometryHolder geometry = shape.getGeometry(); geometry.getType()) {
-						case PxGeometryType::eSPHERE: scaling = PxVec3(2 * geometry.sphere().radius); break;
-						default: throw;
+		void SelectLODs(const XMFLOAT3& viewPosition, float maxAngularError = 1e-3f) {
+			const PxVec3 position(viewPosition.x, viewPosition.y, -viewPosition.z);
+			for (size_t i = 0; i < size(RenderObjects); i++) {
+				auto& renderObject = RenderObjects[i];
+				if (size(renderObject.LODs) < 2) {
+					continue;
+				}
+
+				const auto radius = m_radii[i];
+				const auto distance = max((m_poses[i].p - position).magnitude() - radius, numeric_limits<float>::epsilon());
+
+				auto level = size(renderObject.LODs) - 1;
+				while (level && renderObject.LODs[level].Error * radius / distance > maxAngularError) {
+					level--;
+				}
+				if (const auto& mesh = renderObject.LODs[level].Mesh; renderObject.Mesh != mesh) {
+					renderObject.Mesh = mesh;
+					renderObject.Generation++;
+				}
+			}
+		}
+
+		void UpdateTextureResidency(CommandList& commandList, const XMFLOAT3& viewPosition, float projectionScale) {
+			const PxVec3 position(viewPosition.x, viewPosition.y, -viewPosition.z);
+			for (size_t i = 0; i < size(RenderObjects); i++) {
+				const auto radius = m_radii[i];
+				const auto distance = max((m_poses[i].p - position).magnitude() - radius, numeric_limits<float>::epsilon());
+
+				const auto screenSize = 2 * radius / distance * projectionScale;
+				for (const auto& texture : RenderObjects[i].Textures) {
+					if (texture) {
+						m_textureResidencyManager.Request(*texture, screenSize);
 					}
+				}
+			}
 
-					PxMat44 world(PxVec4(1, 1, -1, 1));
-					world *= PxShapeExt::getGlobalPose(shape, *shape.getActor());
-					world.scale(PxVec4(scaling, 1));
-					XMFLOAT3X4 transform;
-					XMStoreFloat3x4(&transform, reinterpret_cast<const XMMATRIX&>(*world.front()));
-					return transform;
-				};
-				InstanceData instanceData;
-				instanceData.FirstGeometryIndex = objectIndex;
-				if (instanceIndex < size(m_instanceData)) {
-					instanceData.PreviousObjectToWorld = m_instanceData[instanceIndex].ObjectToWorld;
-					instanceData.ObjectToWorld = Transform();
-					m_instanceData[instanceIndex] = instanceData;
+			const auto replacements = m_textureResidencyManager.Update(commandList);
+			if (empty(replacements)) {
+				return;
+			}
+
+			for (auto& renderObject : RenderObjects) {
+				for (auto& texture : renderObject.Textures) {
+					if (const auto pReplacement = replacements.find(texture.get()); pReplacement != cend(replacements)) {
+						texture = pReplacement->second;
+						renderObject.Generation++;
+					}
 				}
-				else {
-					instanceData.PreviousObjectToWorld = instanceData.ObjectToWorld = Transform();
-					m_instanceData.emplace_back(instanceData);
+			}
+		}
+
+		void Refresh() {
+			if (m_poseReader) {
+				const auto time = steady_clock::now();
+				const duration<double> timeStep(m_poseReader->GetTimeStep());
+				auto& snapshot = m_poseSnapshots.GetFront();
+				snapshot.Time = max(snapshot.Time, time - duration_cast<steady_clock::duration>(MaxElapsedTime));
+				while (snapshot.Time + duration_cast<steady_clock::duration>(timeStep) <= time) {
+					swap(m_previousPoseSnapshot, snapshot);
+					snapshot.Time = m_previousPoseSnapshot.Time + duration_cast<steady_clock::duration>(timeStep);
+					if (ReplayPoses(snapshot.Poses)) {
+						m_previousPoseSnapshot.Poses = snapshot.Poses;
+					}
 				}
-				instanceIndex++;
-				objectIndex++;
 			}
-			m_objectCount = objectIndex;
+			else if (m_poseSnapshots.HasUpdate()) {
+				swap(m_previousPoseSnapshot, m_poseSnapshots.GetFront());
+				m_poseSnapshots.Consume();
+			}
+
+			const auto& [Time, Poses] = m_poseSnapshots.GetFront();
+			const auto& previousSnapshot = m_previousPoseSnapshot;
+
+			auto alpha = 1.0f;
+			if (size(previousSnapshot.Poses) == size(Poses) && Time > previousSnapshot.Time) {
+				const auto renderTime = steady_clock::now() - (m_poseReader ? duration<double>(m_poseReader->GetTimeStep()) : SimulationTimeStep);
+				alpha = clamp(static_cast<float>(duration<double>(renderTime - previousSnapshot.Time) / duration<double>(Time - previousSnapshot.Time)), 0.0f, 1.0f);
+			}
+
+			const auto objectCount = size(RenderObjects), previousObjectCount = size(m_instanceData);
+			m_instanceData.resize(max(objectCount, previousObjectCount));
+			m_dirtyInstanceFlags.resize(size(m_instanceData));
+			m_dirtyInstanceDescFlags.resize(size(m_instanceData));
+			m_poses.resize(objectCount);
+
+			ParallelFor(objectCount, PoseBatch::Capacity, [&](size_t first, size_t last) {
+				PoseBatch poses;
+				for (auto i = first; i < last; i++) {
+					auto& pose = m_poses[i] = Poses[i];
+					if (alpha < 1) {
+						const auto& previousPose = previousSnapshot.Poses[i];
+						XMStoreFloat3(reinterpret_cast<XMFLOAT3*>(&pose.p), XMVectorLerp(XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(&previousPose.p)), XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(&pose.p)), alpha));
+						XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&pose.q), XMQuaternionSlerp(XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&previousPose.q)), XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&pose.q)), alpha));
+					}
+
+					const auto& mesh = *RenderObjects[i].Mesh;
+					poses.Add(reinterpret_cast<const XMFLOAT4&>(pose.q), reinterpret_cast<const XMFLOAT3&>(pose.p), 2 * m_radii[i], mesh.PositionScale, mesh.PositionBias);
+				}
+
+				XMFLOAT3X4 transforms[PoseBatch::Capacity];
+				ComputeFlippedObjectToWorld(poses, transforms);
+
+				for (auto i = first; i < last; i++) {
+					auto& instanceData = m_instanceData[i];
+					const auto& transform = transforms[i - first];
+					if (i < previousObjectCount
+						&& !memcmp(&instanceData.PreviousObjectToWorld, &instanceData.ObjectToWorld, sizeof(transform))
+						&& !memcmp(&instanceData.ObjectToWorld, &transform, sizeof(transform))) {
+						continue;
+					}
+					instanceData.FirstGeometryIndex = static_cast<uint32_t>(i);
+					instanceData.PreviousObjectToWorld = i < previousObjectCount ? instanceData.ObjectToWorld : transform;
+					instanceData.ObjectToWorld = transform;
+					m_dirtyInstanceFlags[i] = m_dirtyInstanceDescFlags[i] = true;
+				}
+			});
+
+			m_objectCount = static_cast<uint32_t>(objectCount);
 		}
 
 		auto GetTopLevelAccelerationStructure() const {
@@ -232,7 +588,7 @@ export {
 
 				for (const auto& renderObject : RenderObjects) {
 					const auto mesh = renderObject.Mesh.get();
-					const auto [first, second] = m_bottomLevelAccelerationStructureIDs.try_emplace(mesh);
+					const auto [first, second] = m_bottomLevelAccelerationStructures.try_emplace(mesh);
 					if (!second) {
 						continue;
 					}
@@ -240,7 +596,8 @@ export {
 					auto& _geometryDescs = geometryDescs.emplace_back(initializer_list{ CreateGeometryDesc(
 						*mesh->Vertices, *mesh->Indices,
 						renderObject.Material.AlphaMode == AlphaMode::Opaque ?
-						D3D12_RAYTRACING_GEOMETRY_FLAG_OPAQUE : D3D12_RAYTRACING_GEOMETRY_FLAG_NONE)
+						D3D12_RAYTRACING_GEOMETRY_FLAG_OPAQUE : D3D12_RAYTRACING_GEOMETRY_FLAG_NONE,
+						NULL, mesh->PositionFormat)
 						});
 					newInputs.emplace_back(D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_INPUTS{
 						.Type = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL,
@@ -255,32 +612,109 @@ export {
 					const auto IDs = commandList.BuildAccelerationStructures(newInputs);
 
 					for (size_t i = 0; const auto & mesh : newMeshes) {
-						auto& ID = m_bottomLevelAccelerationStructureIDs.at(mesh);
-						ID.first = IDs[i++];
-						ID.second = mesh->OnDestroyed.append([&](Mesh* pMesh) {
-							if (const auto pID = m_bottomLevelAccelerationStructureIDs.find(pMesh);
-							pID != cend(m_bottomLevelAccelerationStructureIDs)) {
-							m_unreferencedBottomLevelAccelerationStructureIDs.emplace_back(pID->second.first);
-							m_bottomLevelAccelerationStructureIDs.erase(pID);
+						auto& accelerationStructure = m_bottomLevelAccelerationStructures.at(mesh);
+						accelerationStructure.ID = IDs[i++];
+						accelerationStructure.OnMeshDestroyed = mesh->OnDestroyed.append([&](Mesh* pMesh) {
+							if (const auto pAccelerationStructure = m_bottomLevelAccelerationStructures.find(pMesh);
+							pAccelerationStructure != cend(m_bottomLevelAccelerationStructures)) {
+							m_unreferencedBottomLevelAccelerationStructureIDs.emplace_back(pAccelerationStructure->second.ID);
+							m_bottomLevelAccelerationStructures.erase(pAccelerationStructure);
 						}
 							});
 					}
 				}
 			}
 
-			vector<D3D12_RAYTRACING_INSTANCE_DESC> instanceDescs;
-			instanceDescs.reserve(size(m_instanceData));
-			for (uint32_t instanceIndex = 0; const auto & renderObject : RenderObjects) {
-				const auto& instanceData = m_instanceData[instanceIndex++];
-				auto& instanceDesc = instanceDescs.emplace_back(D3D12_RAYTRACING_INSTANCE_DESC{
-					.InstanceID = instanceData.FirstGeometryIndex,
-					.InstanceMask = renderObject.IsVisible ? ~0u : 0,
-					.InstanceContributionToHitGroupIndex = instanceData.FirstGeometryIndex,
-					.AccelerationStructure = accelerationStructureManager.GetAccelStructGPUVA(m_bottomLevelAccelerationStructureIDs.at(renderObject.Mesh.get()).first)
-					});
-				reinterpret_cast<XMFLOAT3X4&>(instanceDesc.Transform) = instanceData.ObjectToWorld;
+			auto isAddressChanged = false;
+			for (auto& [_, accelerationStructure] : m_bottomLevelAccelerationStructures) {
+				if (const auto address = accelerationStructureManager.GetAccelStructGPUVA(accelerationStructure.ID);
+					accelerationStructure.Address != address) {
+					accelerationStructure.Address = address;
+					isAddressChanged = true;
+				}
+			}
+
+			const auto instanceCount = size(RenderObjects);
+			auto& instanceDescs = m_topLevelAccelerationStructure.InstanceDescs;
+			const auto resize = instanceCount != size(m_instanceDescs);
+			if (resize) {
+				commandList.Retire(move(instanceDescs));
+				instanceDescs = instanceCount ? GPUBuffer::CreateDefault<D3D12_RAYTRACING_INSTANCE_DESC>(m_deviceContext, instanceCount) : nullptr;
+				m_instanceDescs.assign(instanceCount, {});
+				m_instanceMeshes.assign(instanceCount, nullptr);
 			}
-			BuildTopLevelAccelerationStructure(commandList, D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_PREFER_FAST_TRACE, instanceDescs, false, m_topLevelAccelerationStructure);
+			m_changedInstanceDescFlags.assign(instanceCount, false);
+			atomic<bool> isBottomLevelAccelerationStructureChanged = false;
+			atomic<float> motion = 0;
+			if (instanceCount) {
+				ParallelFor(instanceCount, 1024, [&](size_t first, size_t last) {
+					float batchMotion = 0;
+					for (auto i = first; i < last; i++) {
+						const auto& renderObject = RenderObjects[i];
+						auto& instanceDesc = m_instanceDescs[i];
+						auto isChanged = resize;
+
+						if (resize) {
+							instanceDesc.InstanceID = instanceDesc.InstanceContributionToHitGroupIndex = m_instanceData[i].FirstGeometryIndex;
+						}
+
+						if (exchange(m_dirtyInstanceDescFlags[i], false) || resize) {
+							const auto& instanceData = m_instanceData[i];
+							const auto& transform = instanceData.ObjectToWorld, & previousTransform = instanceData.PreviousObjectToWorld;
+							const auto scale = max({
+								Vector3(transform._11, transform._21, transform._31).Length(),
+								Vector3(transform._12, transform._22, transform._32).Length(),
+								Vector3(transform._13, transform._23, transform._33).Length()
+								});
+							if (scale > 0) {
+								batchMotion += Vector3(transform._14 - previousTransform._14, transform._24 - previousTransform._24, transform._34 - previousTransform._34).Length() / scale;
+							}
+							reinterpret_cast<XMFLOAT3X4&>(instanceDesc.Transform) = transform;
+							isChanged = true;
+						}
+
+						if (const UINT instanceMask = renderObject.IsVisible ? 0xff : 0; instanceDesc.InstanceMask != instanceMask) {
+							instanceDesc.InstanceMask = instanceMask;
+							isChanged = true;
+						}
+
+						if (auto& mesh = m_instanceMeshes[i]; isAddressChanged || mesh != renderObject.Mesh.get()) {
+							mesh = renderObject.Mesh.get();
+							if (const auto address = m_bottomLevelAccelerationStructures.at(mesh).Address; instanceDesc.AccelerationStructure != address) {
+								instanceDesc.AccelerationStructure = address;
+								isChanged = true;
+								isBottomLevelAccelerationStructureChanged = true;
+							}
+						}
+
+						m_changedInstanceDescFlags[i] = isChanged;
+					}
+					motion += batchMotion;
+				});
+
+				vector<BufferRange> ranges;
+				for (size_t i = 0; i < instanceCount; i++) {
+					if (!m_changedInstanceDescFlags[i]) {
+						continue;
+					}
+					constexpr auto Size = sizeof(D3D12_RAYTRACING_INSTANCE_DESC);
+					if (!empty(ranges) && ranges.back().Offset + ranges.back().Size == Size * i) {
+						ranges.back().Size += Size;
+					}
+					else {
+						ranges.emplace_back(BufferRange{ Size * i, Size });
+					}
+				}
+				commandList.Copy(*instanceDescs, data(m_instanceDescs), ranges);
+			}
+			BuildTopLevelAccelerationStructure(
+				commandList,
+				D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_PREFER_FAST_TRACE | D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_ALLOW_UPDATE,
+				static_cast<UINT>(instanceCount),
+				resize,
+				m_topLevelAccelerationStructure,
+				m_refitPolicy.ShouldRefit(resize || isBottomLevelAccelerationStructureChanged, instanceCount ? motion / static_cast<float>(instanceCount) : 0)
+			);
 		}
 
 		void CollectGarbage() {
@@ -293,14 +727,111 @@ export {
 	protected:
 		virtual void Tick(double elapsedSeconds) = 0;
 
+		void StopSimulation() { m_simulationThread = jthread(); }
+
 	private:
 		const DeviceContext& m_deviceContext;
 
+		MeshRegistry m_meshRegistry;
+
+		TextureCache m_textureCache;
+		TextureResidencyManager m_textureResidencyManager;
+
 		vector<InstanceData> m_instanceData;
+		vector<uint8_t> m_dirtyInstanceFlags, m_dirtyInstanceDescFlags;
 		uint32_t m_objectCount{};
 
+		struct BottomLevelAccelerationStructure {
+			uint64_t ID{};
+			Mesh::DestroyEvent::Handle OnMeshDestroyed;
+			D3D12_GPU_VIRTUAL_ADDRESS Address{};
+		};
 		vector<uint64_t> m_unreferencedBottomLevelAccelerationStructureIDs;
-		unordered_map<Mesh*, pair<uint64_t, Mesh::DestroyEvent::Handle>> m_bottomLevelAccelerationStructureIDs;
+		unordered_map<Mesh*, BottomLevelAccelerationStructure> m_bottomLevelAccelerationStructures;
 		TopLevelAccelerationStructure m_topLevelAccelerationStructure;
+		RefitPolicy m_refitPolicy;
+		vector<D3D12_RAYTRACING_INSTANCE_DESC> m_instanceDescs;
+		vector<uint8_t> m_changedInstanceDescFlags;
+		vector<const Mesh*> m_instanceMeshes;
+
+		struct PoseSnapshot {
+			steady_clock::time_point Time;
+			vector<PxTransform> Poses;
+		};
+		TripleBuffer<PoseSnapshot> m_poseSnapshots;
+		PoseSnapshot m_previousPoseSnapshot;
+		vector<PxTransform> m_poses;
+		vector<PxReal> m_radii;
+
+		PoseStreamMode m_poseStreamMode = PoseStreamMode::None;
+		path m_poseStreamFilePath;
+		unique_ptr<PoseStream::Writer> m_poseWriter;
+		unique_ptr<PoseStream::Reader> m_poseReader;
+		vector<PxTransform> m_recordedPoses;
+
+		jthread m_simulationThread;
+
+		void CapturePoses(vector<PxTransform>& poses) const {
+			poses.resize(size(RenderObjects));
+			ParallelFor(size(RenderObjects), PoseBatch::Capacity, [&](size_t first, size_t last) {
+				for (auto i = first; i < last; i++) {
+					const auto& shape = *RenderObjects[i].Shape;
+					poses[i] = PxShapeExt::getGlobalPose(shape, *shape.getActor());
+				}
+			});
+		}
+
+		void PublishPoseSnapshot(steady_clock::time_point time) {
+			auto& [Time, Poses] = m_poseSnapshots.GetBack();
+			Time = time;
+			CapturePoses(Poses);
+			m_poseSnapshots.Publish();
+		}
+
+		void RecordPoses() {
+			CapturePoses(m_recordedPoses);
+			m_poseWriter->Write(m_recordedPoses);
+		}
+
+		bool ReplayPoses(vector<PxTransform>& poses) {
+			poses.resize(size(RenderObjects));
+			if (m_poseReader->Read(poses)) {
+				return false;
+			}
+			m_poseReader->Rewind();
+			if (!m_poseReader->Read(poses)) {
+				Throw<runtime_error>(format("{}: Pose stream is empty", m_poseStreamFilePath.string()));
+			}
+			return true;
+		}
+
+		void StartSimulation() {
+			m_simulationThread = jthread([&](stop_token stopToken) {
+				auto previousTime = steady_clock::now();
+				duration<double> accumulatedTime{};
+				while (!stopToken.stop_requested()) {
+					const auto time = steady_clock::now();
+					accumulatedTime += min(duration<double>(time - previousTime), MaxElapsedTime);
+					previousTime = time;
+
+					if (IsStatic()) {
+						accumulatedTime = {};
+					}
+					else if (accumulatedTime >= SimulationTimeStep) {
+						do {
+							Tick(SimulationTimeStep.count());
+							if (m_poseWriter) {
+								RecordPoses();
+							}
+							accumulatedTime -= SimulationTimeStep;
+						} while (accumulatedTime >= SimulationTimeStep);
+
+						PublishPoseSnapshot(time - duration_cast<steady_clock::duration>(accumulatedTime));
+					}
+
+					this_thread::sleep_until(time + duration_cast<steady_clock::duration>(SimulationTimeStep - accumulatedTime));
+				}
+			});
+		}
 	};
 }
@@ -0,0 +1,502 @@
+module;
+
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <span>
+#include <unordered_map>
+#include <variant>
+
+#include "directxtk12/GamePad.h"
+#include "directxtk12/Keyboard.h"
+#include "directxtk12/Mouse.h"
+#include "directxtk12/SimpleMath.h"
+
+#include "nlohmann/json.hpp"
+
+#include "PhysX.h"
+
+export module SceneFile;
+
+export import Scene;
+
+import ErrorHelpers;
+import Material;
+import PhysXCpuDispatcher;
+import ResourceHelpers;
+
+using namespace DirectX;
+using namespace DirectX::SimpleMath;
+using namespace ErrorHelpers;
+using namespace physx;
+using namespace ResourceHelpers;
+using namespace std;
+using namespace std::filesystem;
+
+using GamepadButtonState = GamePad::ButtonStateTracker::ButtonState;
+using Key = Keyboard::Keys;
+
+namespace {
+	constexpr uint32_t Magic = 0x4e435353, Version = 1;
+
+	constexpr string_view TextureMapTypeNames[]{ "BaseColor", "EmissiveColor", "Metallic", "Roughness", "MetallicRoughness", "Transmission", "Normal" };
+	static_assert(size(TextureMapTypeNames) == TextureMapType::Count);
+
+	template <typename T>
+	span<float> AsFloats(T& value) { return { reinterpret_cast<float*>(&value), sizeof(T) / sizeof(float) }; }
+
+	PxVec3 ToPxVec3(const XMFLOAT3& value) { return { value.x, value.y, value.z }; }
+}
+
+export {
+	struct SceneFile {
+		struct StringRef { uint32_t Offset{}, Length{}; };
+
+		struct HeaderRecord {
+			XMFLOAT3 CameraPosition{};
+			XMFLOAT4 CameraRotation{ 0, 0, 0, 1 };
+			XMFLOAT4 EnvironmentLightColor{ 0, 0, 0, -1 }, EnvironmentLightRotation{ 0, 0, 0, 1 };
+			StringRef EnvironmentLightTexture;
+			uint32_t ThreadCount = 8;
+			XMFLOAT3 Gravity{};
+			float StaticFriction = 0.5f, DynamicFriction = 0.5f, Restitution = 0.6f;
+		};
+
+		struct MeshRecord {
+			StringRef URI;
+			float Diameter = 1;
+			uint32_t Tessellation = 3, LODCount{}, Optimize{}, QuantizePositions{};
+		};
+
+		struct ObjectRecord {
+			StringRef Name, MeshURI;
+			XMFLOAT3 Position{};
+			XMFLOAT4 Rotation{ 0, 0, 0, 1 };
+			float Radius = 0.5f, Density = 1, Mass = -1;
+			XMFLOAT3 LinearVelocity{}, AngularVelocity{};
+			Material Material;
+			StringRef Textures[TextureMapType::Count];
+		};
+
+		HeaderRecord Header;
+		vector<MeshRecord> Meshes;
+		vector<ObjectRecord> Objects;
+		string Strings;
+
+		string_view GetString(const StringRef& value) const { return string_view(Strings).substr(value.Offset, value.Length); }
+
+		static SceneFile Load(const path& filePath) {
+			if (filePath.extension() != L".json") {
+				return LoadBinary(filePath);
+			}
+
+			const auto cacheFilePath = path(*__wargv).replace_filename(L"Cache") / L"Scenes" / format("{:016X}.scene", hash_value(absolute(filePath)));
+			if (error_code errorCode; last_write_time(cacheFilePath, errorCode) >= last_write_time(filePath) && !errorCode) {
+				try {
+					return LoadBinary(cacheFilePath);
+				}
+				catch (...) {}
+			}
+
+			auto sceneFile = LoadJSON(filePath);
+			try {
+				sceneFile.Save(cacheFilePath);
+			}
+			catch (...) {}
+			return sceneFile;
+		}
+
+		void Save(const path& filePath) const {
+			const FileHeader fileHeader{ .MeshCount = size(Meshes), .ObjectCount = size(Objects), .StringsSize = size(Strings) };
+
+			if (filePath.has_parent_path()) {
+				create_directories(filePath.parent_path());
+			}
+
+			auto temporaryFilePath = filePath;
+			temporaryFilePath += L".tmp";
+			{
+				ofstream file(temporaryFilePath, ios::binary | ios::trunc);
+				file.write(reinterpret_cast<const char*>(&fileHeader), sizeof(fileHeader));
+				file.write(reinterpret_cast<const char*>(&Header), sizeof(Header));
+				file.write(reinterpret_cast<const char*>(data(Meshes)), sizeof(MeshRecord) * size(Meshes));
+				file.write(reinterpret_cast<const char*>(data(Objects)), sizeof(ObjectRecord) * size(Objects));
+				file.write(data(Strings), size(Strings));
+				if (!file) {
+					Throw<runtime_error>(format("{}: Failed to write scene file", temporaryFilePath.string()));
+				}
+			}
+			rename(temporaryFilePath, filePath);
+		}
+
+	private:
+		struct FileHeader {
+			uint32_t Magic = ::Magic, Version = ::Version;
+			uint32_t HeaderSize = sizeof(HeaderRecord), MeshRecordSize = sizeof(MeshRecord), ObjectRecordSize = sizeof(ObjectRecord), _{};
+			uint64_t MeshCount{}, ObjectCount{}, StringsSize{};
+
+			auto GetSize() const { return sizeof(FileHeader) + HeaderSize + MeshRecordSize * MeshCount + ObjectRecordSize * ObjectCount + StringsSize; }
+
+			bool IsValid() const {
+				return Magic == ::Magic && Version == ::Version
+					&& HeaderSize == sizeof(HeaderRecord) && MeshRecordSize == sizeof(MeshRecord) && ObjectRecordSize == sizeof(ObjectRecord);
+			}
+		};
+
+		class JSONReader : public nlohmann::json_sax<nlohmann::json> {
+		public:
+			JSONReader(SceneFile& sceneFile, const path& filePath) : m_sceneFile(sceneFile), m_filePath(filePath) {}
+
+			bool null() override { return true; }
+
+			bool boolean(bool value) override { return SetNumber(value); }
+
+			bool number_integer(number_integer_t value) override { return SetNumber(static_cast<double>(value)); }
+
+			bool number_unsigned(number_unsigned_t value) override { return SetNumber(static_cast<double>(value)); }
+
+			bool number_float(number_float_t value, const string_t&) override { return SetNumber(value); }
+
+			bool string(string_t& value) override {
+				const auto field = GetField();
+				if (const auto p = get_if<StringRef*>(&field)) {
+					auto [pString, isInserted] = m_strings.try_emplace(value);
+					if (isInserted) {
+						pString->second = { static_cast<uint32_t>(size(m_sceneFile.Strings)), static_cast<uint32_t>(size(value)) };
+						m_sceneFile.Strings += value;
+					}
+					**p = pString->second;
+				}
+				else if (const auto p = get_if<AlphaMode*>(&field)) {
+					if (value == "Opaque") **p = AlphaMode::Opaque;
+					else if (value == "Mask") **p = AlphaMode::Mask;
+					else if (value == "Blend") **p = AlphaMode::Blend;
+				}
+				return true;
+			}
+
+			bool binary(binary_t&) override { return true; }
+
+			bool start_object(size_t) override {
+				auto context = Context::Ignored;
+				switch (m_contexts.back()) {
+					case Context::Document: context = Context::Root; break;
+
+					case Context::Root:
+						if (m_key == "Camera") context = Context::Camera;
+						else if (m_key == "EnvironmentLight") context = Context::EnvironmentLight;
+						else if (m_key == "Physics") context = Context::Physics;
+						break;
+
+					case Context::Meshes:
+						m_sceneFile.Meshes.emplace_back();
+						context = Context::Mesh;
+						break;
+
+					case Context::Objects:
+						m_sceneFile.Objects.emplace_back();
+						context = Context::Object;
+						break;
+
+					case Context::Object:
+						if (m_key == "Material") context = Context::Material;
+						else if (m_key == "Textures") context = Context::Textures;
+						break;
+
+					default: break;
+				}
+				m_contexts.emplace_back(context);
+				return true;
+			}
+
+			bool key(string_t& value) override {
+				m_key = value;
+				return true;
+			}
+
+			bool end_object() override {
+				m_contexts.pop_back();
+				return true;
+			}
+
+			bool start_array(size_t) override {
+				auto context = Context::Ignored;
+				if (m_contexts.back() == Context::Root) {
+					if (m_key == "Meshes") context = Context::Meshes;
+					else if (m_key == "Objects") context = Context::Objects;
+				}
+				else if (const auto field = GetField(); holds_alternative<span<float>>(field)) {
+					m_vector = get<span<float>>(field);
+					m_vectorIndex = 0;
+					context = Context::Vector;
+				}
+				m_contexts.emplace_back(context);
+				return true;
+			}
+
+			bool end_array() override {
+				m_contexts.pop_back();
+				return true;
+			}
+
+			bool parse_error(size_t, const std::string&, const nlohmann::detail::exception& exception) override {
+				Throw<runtime_error>(format("{}: {}", m_filePath.string(), exception.what()));
+			}
+
+		private:
+			enum class Context { Document, Root, Camera, EnvironmentLight, Physics, Meshes, Mesh, Objects, Object, Material, Textures, Vector, Ignored };
+
+			using Field = variant<monostate, float*, uint32_t*, span<float>, StringRef*, AlphaMode*>;
+
+			SceneFile& m_sceneFile;
+			const path& m_filePath;
+
+			vector<Context> m_contexts{ Context::Document };
+			std::string m_key;
+
+			span<float> m_vector;
+			size_t m_vectorIndex{};
+
+			unordered_map<std::string, StringRef> m_strings;
+
+			Field GetField() {
+				const string_view key = m_key;
+				auto& header = m_sceneFile.Header;
+				switch (m_contexts.back()) {
+					case Context::Camera:
+						if (key == "Position") return AsFloats(header.CameraPosition);
+						if (key == "Rotation") return AsFloats(header.CameraRotation);
+						break;
+
+					case Context::EnvironmentLight:
+						if (key == "Color") return AsFloats(header.EnvironmentLightColor);
+						if (key == "Rotation") return AsFloats(header.EnvironmentLightRotation);
+						if (key == "Texture") return &header.EnvironmentLightTexture;
+						break;
+
+					case Context::Physics:
+						if (key == "ThreadCount") return &header.ThreadCount;
+						if (key == "Gravity") return AsFloats(header.Gravity);
+						if (key == "StaticFriction") return &header.StaticFriction;
+						if (key == "DynamicFriction") return &header.DynamicFriction;
+						if (key == "Restitution") return &header.Restitution;
+						break;
+
+					case Context::Mesh: {
+						auto& mesh = m_sceneFile.Meshes.back();
+						if (key == "URI") return &mesh.URI;
+						if (key == "Diameter") return &mesh.Diameter;
+						if (key == "Tessellation") return &mesh.Tessellation;
+						if (key == "LODCount") return &mesh.LODCount;
+						if (key == "Optimize") return &mesh.Optimize;
+						if (key == "QuantizePositions") return &mesh.QuantizePositions;
+					} break;
+
+					case Context::Object: {
+						auto& object = m_sceneFile.Objects.back();
+						if (key == "Name") return &object.Name;
+						if (key == "Mesh") return &object.MeshURI;
+						if (key == "Position") return AsFloats(object.Position);
+						if (key == "Rotation") return AsFloats(object.Rotation);
+						if (key == "Radius") return &object.Radius;
+						if (key == "Density") return &object.Density;
+						if (key == "Mass") return &object.Mass;
+						if (key == "LinearVelocity") return AsFloats(object.LinearVelocity);
+						if (key == "AngularVelocity") return AsFloats(object.AngularVelocity);
+					} break;
+
+					case Context::Material: {
+						auto& material = m_sceneFile.Objects.back().Material;
+						if (key == "BaseColor") return AsFloats(material.BaseColor);
+						if (key == "EmissiveStrength") return &material.EmissiveStrength;
+						if (key == "EmissiveColor") return AsFloats(material.EmissiveColor);
+						if (key == "Metallic") return &material.Metallic;
+						if (key == "Roughness") return &material.Roughness;
+						if (key == "IOR") return &material.IOR;
+						if (key == "Transmission") return &material.Transmission;
+						if (key == "AlphaMode") return &material.AlphaMode;
+						if (key == "AlphaCutoff") return &material.AlphaCutoff;
+					} break;
+
+					case Context::Textures:
+						if (const auto pName = ranges::find(TextureMapTypeNames, key); pName != cend(TextureMapTypeNames)) {
+							return &m_sceneFile.Objects.back().Textures[pName - cbegin(TextureMapTypeNames)];
+						}
+						break;
+
+					default: break;
+				}
+				return {};
+			}
+
+			bool SetNumber(double value) {
+				if (m_contexts.back() == Context::Vector) {
+					if (m_vectorIndex < size(m_vector)) {
+						m_vector[m_vectorIndex++] = static_cast<float>(value);
+					}
+				}
+				else if (const auto field = GetField(); holds_alternative<float*>(field)) {
+					*get<float*>(field) = static_cast<float>(value);
+				}
+				else if (holds_alternative<uint32_t*>(field)) {
+					*get<uint32_t*>(field) = static_cast<uint32_t>(value);
+				}
+				return true;
+			}
+		};
+
+		static SceneFile LoadJSON(const path& filePath) {
+			std::string content(file_size(filePath), 0);
+			if (ifstream file(filePath, ios::binary); !file.read(data(content), size(content))) {
+				Throw<runtime_error>(format("{}: Failed to read scene file", filePath.string()));
+			}
+
+			SceneFile sceneFile;
+			JSONReader reader(sceneFile, filePath);
+			nlohmann::json::sax_parse(content, &reader);
+			return sceneFile;
+		}
+
+		static SceneFile LoadBinary(const path& filePath) {
+			ifstream file(filePath, ios::binary);
+			const auto fileSize = file_size(filePath);
+			FileHeader fileHeader;
+			if (!file.read(reinterpret_cast<char*>(&fileHeader), sizeof(fileHeader))
+				|| !fileHeader.IsValid()
+				|| fileHeader.MeshCount > fileSize / sizeof(MeshRecord)
+				|| fileHeader.ObjectCount > fileSize / sizeof(ObjectRecord)
+				|| fileHeader.StringsSize > fileSize
+				|| fileSize != fileHeader.GetSize()) {
+				Throw<runtime_error>(format("{}: Invalid scene file", filePath.string()));
+			}
+
+			SceneFile sceneFile;
+			sceneFile.Meshes.resize(fileHeader.MeshCount);
+			sceneFile.Objects.resize(fileHeader.ObjectCount);
+			sceneFile.Strings.resize(fileHeader.StringsSize);
+			file.read(reinterpret_cast<char*>(&sceneFile.Header), sizeof(sceneFile.Header));
+			file.read(reinterpret_cast<char*>(data(sceneFile.Meshes)), sizeof(MeshRecord) * size(sceneFile.Meshes));
+			file.read(reinterpret_cast<char*>(data(sceneFile.Objects)), sizeof(ObjectRecord) * size(sceneFile.Objects));
+			file.read(data(sceneFile.Strings), size(sceneFile.Strings));
+			if (!file) {
+				Throw<runtime_error>(format("{}: Failed to read scene file", filePath.string()));
+			}
+
+			const auto IsValid = [&](const StringRef& value) { return static_cast<uint64_t>(value.Offset) + value.Length <= size(sceneFile.Strings); };
+			if (!IsValid(sceneFile.Header.EnvironmentLightTexture)
+				|| !ranges::all_of(sceneFile.Meshes, [&](const MeshRecord& mesh) { return IsValid(mesh.URI); })
+				|| !ranges::all_of(sceneFile.Objects, [&](const ObjectRecord& object) { return IsValid(object.Name) && IsValid(object.MeshURI) && ranges::all_of(object.Textures, IsValid); })) {
+				Throw<runtime_error>(format("{}: Invalid scene file", filePath.string()));
+			}
+
+			return sceneFile;
+		}
+	};
+
+	struct FileSceneDesc : SceneDesc {
+		explicit FileSceneDesc(const path& filePath) {
+			const auto sceneFile = SceneFile::Load(ResolveResourcePath(filePath));
+			const auto& header = sceneFile.Header;
+
+			Camera.Position = header.CameraPosition;
+			Camera.Rotation = header.CameraRotation;
+
+			EnvironmentLight.Color = header.EnvironmentLightColor;
+			EnvironmentLight.Rotation = header.EnvironmentLightRotation;
+			EnvironmentLight.Texture = sceneFile.GetString(header.EnvironmentLightTexture);
+
+			for (const auto& mesh : sceneFile.Meshes) {
+				const std::string URI(sceneFile.GetString(mesh.URI));
+				AddGeoSphere(URI, mesh.Diameter, mesh.Tessellation, { .Optimize = static_cast<bool>(mesh.Optimize), .QuantizePositions = static_cast<bool>(mesh.QuantizePositions) });
+				if (mesh.LODCount) {
+					GenerateLODs(URI, mesh.LODCount);
+				}
+			}
+
+			PhysX = make_shared<::PhysX>(make_unique<PhysXCpuDispatcher>(header.ThreadCount));
+
+			auto& physics = PhysX->GetPhysics();
+			auto& scene = PhysX->GetScene();
+
+			scene.setGravity(ToPxVec3(header.Gravity));
+
+			const auto& material = *physics.createMaterial(header.StaticFriction, header.DynamicFriction, header.Restitution);
+
+			vector<PxActor*> actors;
+			actors.reserve(size(sceneFile.Objects));
+			RenderObjects.reserve(size(sceneFile.Objects));
+			for (const auto& object : sceneFile.Objects) {
+				const auto& rotation = object.Rotation;
+				auto& rigidDynamic = *physics.createRigidDynamic(PxTransform(ToPxVec3(object.Position), PxQuat(rotation.x, rotation.y, rotation.z, rotation.w).getNormalized()));
+
+				RenderObjectDesc renderObject;
+
+				renderObject.Name = sceneFile.GetString(object.Name);
+				renderObject.MeshURI = sceneFile.GetString(object.MeshURI);
+				renderObject.Material = object.Material;
+				for (size_t i = 0; i < TextureMapType::Count; i++) {
+					if (const auto& texture = object.Textures[i]; texture.Length) {
+						renderObject.Textures[i] = sceneFile.GetString(texture);
+					}
+				}
+
+				renderObject.Shape = PxRigidActorExt::createExclusiveShape(rigidDynamic, PxSphereGeometry(object.Radius), material);
+
+				if (object.Mass > 0) {
+					PxRigidBodyExt::setMassAndUpdateInertia(rigidDynamic, &object.Mass, 1);
+				}
+				else {
+					PxRigidBodyExt::updateMassAndInertia(rigidDynamic, object.Density);
+					if (object.Mass == 0) {
+						rigidDynamic.setMass(0);
+					}
+				}
+				rigidDynamic.setAngularDamping(0);
+				rigidDynamic.setLinearVelocity(ToPxVec3(object.LinearVelocity));
+				rigidDynamic.setAngularVelocity(ToPxVec3(object.AngularVelocity));
+
+				actors.emplace_back(&rigidDynamic);
+
+				if (!empty(renderObject.Name)) {
+					RigidActors.try_emplace(renderObject.Name, &rigidDynamic);
+				}
+
+				RenderObjects.emplace_back(move(renderObject));
+			}
+			scene.addActors(data(actors), static_cast<PxU32>(size(actors)));
+		}
+	};
+
+	struct FileScene : Scene {
+		using Scene::Scene;
+
+		~FileScene() override { StopSimulation(); }
+
+		bool IsStatic() const override { return !m_isPhysXRunning; }
+
+		void Tick([[maybe_unused]] double elapsedSeconds, const GamePad::ButtonStateTracker& gamepadStateTracker, const Keyboard::KeyboardStateTracker& keyboardStateTracker, const Mouse::ButtonStateTracker& mouseStateTracker) override {
+			if (mouseStateTracker.GetLastState().positionMode == Mouse::MODE_RELATIVE) {
+				if (gamepadStateTracker.a == GamepadButtonState::PRESSED) {
+					m_isPhysXRunning = !m_isPhysXRunning;
+				}
+				if (keyboardStateTracker.IsKeyPressed(Key::Space)) {
+					m_isPhysXRunning = !m_isPhysXRunning;
+				}
+			}
+
+			if (IsStatic()) {
+				return;
+			}
+
+			Refresh();
+		}
+
+	protected:
+		void Tick(double elapsedSeconds) override { PhysX->Tick(static_cast<float>(min(1.0 / 60, elapsedSeconds))); }
+
+	private:
+		atomic_bool m_isPhysXRunning = true;
+	};
+}
@@ -0,0 +1,207 @@
+module;
+
+#include <algorithm>
+#include <cmath>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include <DirectXMath.h>
+
+#include "PhysX.h"
+
+export module SceneGenerator;
+
+export import Material;
+
+import Random;
+import ThreadHelpers;
+
+using namespace DirectX;
+using namespace physx;
+using namespace std;
+using namespace ThreadHelpers;
+
+namespace {
+	uint64_t MixSeed(uint64_t value) {
+		value += 0x9e3779b97f4a7c15;
+		value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9;
+		value = (value ^ (value >> 27)) * 0x94d049bb133111eb;
+		return value ^ (value >> 31);
+	}
+}
+
+export namespace SceneGenerator {
+	struct Sphere {
+		PxVec3 Center;
+		PxReal Radius;
+	};
+
+	struct Object {
+		Sphere Sphere;
+		Material Material;
+	};
+
+	struct Parameters {
+		uint32_t GridSize = 21;
+		PxReal CellSize = 1;
+
+		uint32_t ObjectCount = 21 * 21;
+
+		PxReal MinRadius = 0.075f, MaxRadius = 0.075f;
+
+		struct MaterialWeights {
+			float Diffuse = 0.3f, Metal = 0.3f, Glass = 0.2f, Emissive = 0.2f;
+		} MaterialWeights;
+
+		PxReal Height = 0.5f;
+
+		uint32_t MaxAttempts = 4;
+
+		uint32_t Seed{};
+	};
+
+	class SpatialHash {
+	public:
+		explicit SpatialHash(PxReal cellSize) : m_cellSize(cellSize) {}
+
+		void Clear() {
+			m_spheres.clear();
+			m_cells.clear();
+		}
+
+		void Insert(const Sphere& sphere) {
+			const auto index = static_cast<uint32_t>(size(m_spheres));
+			m_spheres.emplace_back(sphere);
+			ForEachCell(sphere, [&](uint64_t key) {
+				m_cells[key].emplace_back(index);
+				return false;
+			});
+		}
+
+		bool Overlaps(const Sphere& sphere) const {
+			return ForEachCell(sphere, [&](uint64_t key) {
+				const auto pCell = m_cells.find(key);
+				return pCell != cend(m_cells) && ranges::any_of(pCell->second, [&](uint32_t index) {
+					const auto& [Center, Radius] = m_spheres[index];
+					const auto distance = Radius + sphere.Radius;
+					return (Center - sphere.Center).magnitudeSquared() < distance * distance;
+				});
+			});
+		}
+
+	private:
+		PxReal m_cellSize;
+
+		vector<Sphere> m_spheres;
+		unordered_map<uint64_t, vector<uint32_t>> m_cells;
+
+		bool ForEachCell(const Sphere& sphere, const auto& function) const {
+			const auto GetCoordinate = [&](PxReal value) { return static_cast<int32_t>(floor(value / m_cellSize)); };
+			const auto
+				minX = GetCoordinate(sphere.Center.x - sphere.Radius), maxX = GetCoordinate(sphere.Center.x + sphere.Radius),
+				minZ = GetCoordinate(sphere.Center.z - sphere.Radius), maxZ = GetCoordinate(sphere.Center.z + sphere.Radius);
+			for (auto x = minX; x <= maxX; x++) {
+				for (auto z = minZ; z <= maxZ; z++) {
+					if (function(static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32 | static_cast<uint32_t>(z))) {
+						return true;
+					}
+				}
+			}
+			return false;
+		}
+	};
+
+	Material GenerateMaterial(Random& random, const decltype(Parameters::MaterialWeights)& weights) {
+		const auto RandomFloat4 = [&](float min) {
+			const auto value = random.Float3(min);
+			return XMFLOAT4(value.x, value.y, value.z, 1);
+		};
+		if (const auto randomValue = random.Float(0, weights.Diffuse + weights.Metal + weights.Glass + weights.Emissive);
+			randomValue < weights.Diffuse) {
+			return { .BaseColor = RandomFloat4(0.1f) };
+		}
+		else if (randomValue < weights.Diffuse + weights.Metal) {
+			return {
+				.BaseColor = RandomFloat4(0.1f),
+				.Metallic = 1,
+				.Roughness = random.Float(0, 0.5f)
+			};
+		}
+		else if (randomValue < weights.Diffuse + weights.Metal + weights.Glass) {
+			return {
+				.BaseColor = RandomFloat4(0.1f),
+				.Roughness = random.Float(0, 0.5f),
+				.Transmission = 1
+			};
+		}
+		return {
+			.BaseColor = RandomFloat4(0.1f),
+			.EmissiveStrength = random.Float(1, 10),
+			.EmissiveColor = random.Float3(0.2f),
+			.Metallic = random.Float(0.4f),
+			.Roughness = random.Float(0.3f)
+		};
+	}
+
+	vector<Object> Generate(const Parameters& parameters, span<const Sphere> exclusions = {}) {
+		const auto& [GridSize, CellSize, ObjectCount, MinRadius, MaxRadius, MaterialWeights, Height, MaxAttempts, Seed] = parameters;
+
+		const auto cellCount = static_cast<size_t>(GridSize) * GridSize;
+		if (!cellCount || !ObjectCount) {
+			return {};
+		}
+
+		const auto maxRadius = min(MaxRadius, CellSize / 2), minRadius = min(MinRadius, maxRadius);
+
+		SpatialHash exclusionHash(CellSize);
+		for (const auto& exclusion : exclusions) {
+			exclusionHash.Insert(exclusion);
+		}
+
+		const auto objectsPerCell = ObjectCount / cellCount, remainder = ObjectCount % cellCount;
+		const auto origin = -0.5f * CellSize * static_cast<PxReal>(GridSize);
+
+		vector<Object> objects(ObjectCount);
+		vector<uint8_t> validFlags(ObjectCount);
+		ParallelFor(cellCount, 256, [&](size_t first, size_t last) {
+			SpatialHash cellHash(2 * maxRadius);
+			for (auto cell = first; cell < last; cell++) {
+				const auto count = objectsPerCell + (cell < remainder), offset = objectsPerCell * cell + min(cell, remainder);
+				const auto
+					cellX = origin + CellSize * static_cast<PxReal>(cell % GridSize),
+					cellZ = origin + CellSize * static_cast<PxReal>(cell / GridSize);
+
+				Random random(static_cast<unsigned int>(MixSeed(static_cast<uint64_t>(Seed) << 32 ^ cell)));
+				cellHash.Clear();
+				for (auto i = offset; i < offset + count; i++) {
+					for (uint32_t attempt = 0; attempt < max(MaxAttempts, 1u); attempt++) {
+						const auto radius = random.Float(minRadius, maxRadius);
+						const Sphere sphere{
+							.Center{ cellX + random.Float(radius, CellSize - radius), Height, cellZ + random.Float(radius, CellSize - radius) },
+							.Radius = radius
+						};
+						if (exclusionHash.Overlaps(sphere) || cellHash.Overlaps(sphere)) {
+							continue;
+						}
+
+						cellHash.Insert(sphere);
+						objects[i] = { sphere, GenerateMaterial(random, MaterialWeights) };
+						validFlags[i] = true;
+						break;
+					}
+				}
+			}
+		});
+
+		size_t objectCount = 0;
+		for (size_t i = 0; i < size(objects); i++) {
+			if (validFlags[i]) {
+				objects[objectCount++] = objects[i];
+			}
+		}
+		objects.resize(objectCount);
+
+		return objects;
+	}
+}
@@ -1,9 +1,20 @@
 module;
 
+#include <algorithm>
+#include <atomic>
+#include <cwctype>
 #include <filesystem>
+#include <format>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <mutex>
 #include <span>
+#include <unordered_map>
 
-#include "directx/d3d12.h"
+#include <wrl.h>
+
+#include "directx/d3dx12.h"
 
 #include "DirectXTexEXR.h"
 
@@ -14,11 +25,69 @@ export import Texture;
 import CommandList;
 import DeviceContext;
 import ErrorHelpers;
+import ThreadHelpers;
 
 using namespace DirectX;
 using namespace ErrorHelpers;
+using namespace Microsoft::WRL;
 using namespace std;
 using namespace std::filesystem;
+using namespace ThreadHelpers;
+
+namespace {
+	constexpr uint64_t TranscodeVersion = 3;
+
+	const auto TranscodeCacheDirectoryPath = path(*__wargv).replace_filename(L"Cache") / L"Textures";
+
+	uint64_t HashContent(span<const std::byte> data, uint64_t hash = 0xcbf29ce484222325) {
+		for (const auto value : data) {
+			hash = (hash ^ static_cast<uint8_t>(value)) * 0x100000001b3;
+		}
+		return hash;
+	}
+
+	void GenerateMips(ScratchImage& image, bool isNormalMap) {
+		const auto& metadata = image.GetMetadata();
+		if (metadata.mipLevels > 1
+			|| metadata.dimension == TEX_DIMENSION_TEXTURE3D
+			|| IsCompressed(metadata.format)
+			|| max(metadata.width, metadata.height) == 1) {
+			return;
+		}
+
+		ScratchImage mipChain;
+		ThrowIfFailed(GenerateMipMaps(image.GetImages(), image.GetImageCount(), metadata, TEX_FILTER_FANT | (IsSRGB(metadata.format) ? TEX_FILTER_SRGB : TEX_FILTER_DEFAULT), 0, mipChain));
+
+		if (isNormalMap) {
+			const auto mipLevels = mipChain.GetMetadata().mipLevels;
+			atomic<HRESULT> result = S_OK;
+			ParallelFor(mipChain.GetImageCount(), 1, [&](size_t first, size_t last) {
+				for (auto i = first; i < last; i++) {
+					if (i % mipLevels == 0) {
+						continue;
+					}
+
+					const auto& mipImage = mipChain.GetImages()[i];
+					ScratchImage normalizedImage;
+					const auto hr = TransformImage(mipImage, [](XMVECTOR* outPixels, const XMVECTOR* inPixels, size_t width, size_t) {
+						for (size_t j = 0; j < width; j++) {
+							const auto normal = XMVector3Normalize(XMVectorMultiplyAdd(inPixels[j], g_XMTwo, g_XMNegativeOne));
+							outPixels[j] = XMVectorSelect(inPixels[j], XMVectorMultiplyAdd(normal, g_XMOneHalf, g_XMOneHalf), g_XMSelect1110);
+						}
+					}, normalizedImage);
+					if (FAILED(hr)) {
+						result = hr;
+						continue;
+					}
+					memcpy(mipImage.pixels, normalizedImage.GetPixels(), normalizedImage.GetPixelsSize());
+				}
+			});
+			ThrowIfFailed(result.load());
+		}
+
+		image = move(mipChain);
+	}
+}
 
 #define LOAD_FROM_MEMORY(Loader, forceSRGB, ...) \
 	ScratchImage image; \
@@ -31,30 +100,75 @@ using namespace std::filesystem;
 	return LoadTexture(commandList, image, forceSRGB);
 
 export namespace DirectX::TextureHelpers {
-	unique_ptr<Texture> LoadTexture(CommandList& commandList, const ScratchImage& image, bool forceSRGB = false) {
-		const auto& deviceContext = commandList.GetDeviceContext();
+	enum class TextureCompression { None, Color, NormalMap, SingleChannel };
 
-		vector<D3D12_SUBRESOURCE_DATA> subresourceData;
-		ThrowIfFailed(PrepareUpload(deviceContext, image.GetImages(), image.GetImageCount(), image.GetMetadata(), subresourceData));
+	bool IsValidFirstMip(const TexMetadata& metadata, size_t firstMip) {
+		return firstMip < metadata.mipLevels
+			&& (!IsCompressed(metadata.format) || ((metadata.width >> firstMip) % 4 == 0 && (metadata.height >> firstMip) % 4 == 0));
+	}
+
+	size_t GetFirstMip(const TexMetadata& metadata, size_t maxSize) {
+		size_t firstMip = 0;
+		while (max(metadata.width, metadata.height) >> firstMip > maxSize && IsValidFirstMip(metadata, firstMip + 1)) {
+			firstMip++;
+		}
+		return firstMip;
+	}
+
+	uint64_t GetByteSize(const TexMetadata& metadata, size_t firstMip = 0) {
+		uint64_t byteSize = 0;
+		for (auto mip = firstMip; mip < metadata.mipLevels; mip++) {
+			size_t rowPitch, slicePitch;
+			ThrowIfFailed(ComputePitch(metadata.format, max<size_t>(metadata.width >> mip, 1), max<size_t>(metadata.height >> mip, 1), rowPitch, slicePitch));
+			byteSize += static_cast<uint64_t>(slicePitch) * (metadata.dimension == TEX_DIMENSION_TEXTURE3D ? max<size_t>(metadata.depth >> mip, 1) : metadata.arraySize);
+		}
+		return byteSize;
+	}
 
+	vector<D3D12_SUBRESOURCE_DATA> GetSubresourceData(const DeviceContext& deviceContext, const ScratchImage& image, size_t firstMip = 0) {
 		const auto& metadata = image.GetMetadata();
+
+		vector<D3D12_SUBRESOURCE_DATA> subresourceData;
+		ThrowIfFailed(PrepareUpload(deviceContext, image.GetImages(), image.GetImageCount(), metadata, subresourceData));
+		if (firstMip) {
+			const auto itemCount = size(subresourceData) / metadata.mipLevels;
+			for (size_t item = 0, i = 0; item < itemCount; item++) {
+				for (auto mip = firstMip; mip < metadata.mipLevels; mip++) {
+					subresourceData[i++] = subresourceData[item * metadata.mipLevels + mip];
+				}
+			}
+			subresourceData.resize(itemCount * (metadata.mipLevels - firstMip));
+		}
+		return subresourceData;
+	}
+
+	unique_ptr<Texture> CreateTexture(const DeviceContext& deviceContext, const TexMetadata& metadata, bool forceSRGB = false, size_t firstMip = 0) {
 		TextureDimension dimension;
 		switch (metadata.dimension) {
 			case TEX_DIMENSION_TEXTURE1D: dimension = TextureDimension::_1; break;
 			case TEX_DIMENSION_TEXTURE2D: dimension = TextureDimension::_2; break;
 			case TEX_DIMENSION_TEXTURE3D: dimension = TextureDimension::_3; break;
 		}
-		auto texture = make_unique<Texture>(
+		return make_unique<Texture>(
 			deviceContext,
 			Texture::CreationDesc{
 				.Format = forceSRGB ? MakeSRGB(metadata.format) : metadata.format,
 				.Dimension = dimension,
-				.Width = static_cast<UINT>(metadata.width),
-				.Height = static_cast<UINT>(metadata.height),
-				.DepthOrArraySize = static_cast<UINT16>(dimension == TextureDimension::_3 ? metadata.depth : metadata.arraySize),
-				.MipLevels = static_cast<UINT16>(metadata.mipLevels)
+				.Width = static_cast<UINT>(max<size_t>(metadata.width >> firstMip, 1)),
+				.Height = static_cast<UINT>(max<size_t>(metadata.height >> firstMip, 1)),
+				.DepthOrArraySize = static_cast<UINT16>(dimension == TextureDimension::_3 ? max<size_t>(metadata.depth >> firstMip, 1) : metadata.arraySize),
+				.MipLevels = static_cast<UINT16>(metadata.mipLevels - firstMip)
 			}
 		);
+	}
+
+	unique_ptr<Texture> LoadTexture(CommandList& commandList, const ScratchImage& image, bool forceSRGB = false) {
+		const auto& deviceContext = commandList.GetDeviceContext();
+
+		vector<D3D12_SUBRESOURCE_DATA> subresourceData;
+		ThrowIfFailed(PrepareUpload(deviceContext, image.GetImages(), image.GetImageCount(), image.GetMetadata(), subresourceData));
+
+		auto texture = CreateTexture(deviceContext, image.GetMetadata(), forceSRGB);
 
 		commandList.Copy(*texture, subresourceData);
 		commandList.SetState(*texture, D3D12_RESOURCE_STATE_ALL_SHADER_RESOURCE);
@@ -62,6 +176,30 @@ export namespace DirectX::TextureHelpers {
 		return texture;
 	}
 
+	vector<unique_ptr<Texture>> LoadTextures(CommandList& commandList, span<const ScratchImage> images, span<const size_t> firstMips = {}) {
+		const auto& deviceContext = commandList.GetDeviceContext();
+
+		vector<unique_ptr<Texture>> textures;
+		textures.reserve(size(images));
+		vector<vector<D3D12_SUBRESOURCE_DATA>> subresourceData(size(images));
+		vector<CommandList::SubresourceUpload> uploads;
+		uploads.reserve(size(images));
+		for (size_t i = 0; const auto& image : images) {
+			const auto firstMip = empty(firstMips) ? 0 : firstMips[i];
+			auto& imageSubresourceData = subresourceData[i++];
+			imageSubresourceData = GetSubresourceData(deviceContext, image, firstMip);
+
+			uploads.emplace_back(textures.emplace_back(CreateTexture(deviceContext, image.GetMetadata(), false, firstMip)).get(), imageSubresourceData);
+		}
+
+		commandList.Copy(uploads);
+		for (auto& texture : textures) {
+			commandList.SetState(*texture, D3D12_RESOURCE_STATE_ALL_SHADER_RESOURCE);
+		}
+
+		return textures;
+	}
+
 	unique_ptr<Texture> LoadDDS(
 		CommandList& commandList,
 		span<const std::byte> data,
@@ -116,7 +254,7 @@ export namespace DirectX::TextureHelpers {
 		return texture;
 	}
 
-	unique_ptr<Texture> LoadTexture(CommandList& commandList, const path& filePath, bool forceSRGB = false) {
+	ScratchImage DecodeTexture(const path& filePath, bool forceSRGB = false, TextureCompression compression = TextureCompression::Color, bool generateMips = true) {
 		if (empty(filePath)) {
 			throw invalid_argument("Texture file path cannot be empty");
 		}
@@ -127,12 +265,408 @@ export namespace DirectX::TextureHelpers {
 		}
 
 		const auto extension = filePathExtension.c_str() + 1;
-		auto texture =
-			!_wcsicmp(extension, L"dds") ? LoadDDS(commandList, filePath, forceSRGB) :
-			!_wcsicmp(extension, L"hdr") ? LoadHDR(commandList, filePath) :
-			!_wcsicmp(extension, L"exr") ? LoadEXR(commandList, filePath) :
-			!_wcsicmp(extension, L"tga") ? LoadTGA(commandList, filePath, forceSRGB ? TGA_FLAGS_DEFAULT_SRGB : TGA_FLAGS_NONE) :
-			LoadWIC(commandList, filePath, forceSRGB ? WIC_FLAGS_DEFAULT_SRGB : WIC_FLAGS_NONE);
-		return texture;
+		const auto isDDS = !_wcsicmp(extension, L"dds"), isEXR = !_wcsicmp(extension, L"exr");
+		ScratchImage image;
+
+		if (isDDS || compression == TextureCompression::None) {
+			ThrowIfFailed(
+				isDDS ? LoadFromDDSFileEx(filePath.c_str(), DDS_FLAGS_NONE, nullptr, nullptr, image) :
+				!_wcsicmp(extension, L"hdr") ? LoadFromHDRFile(filePath.c_str(), nullptr, image) :
+				isEXR ? LoadFromEXRFile(filePath.c_str(), nullptr, image) :
+				!_wcsicmp(extension, L"tga") ? LoadFromTGAFile(filePath.c_str(), forceSRGB ? TGA_FLAGS_DEFAULT_SRGB : TGA_FLAGS_NONE, nullptr, image) :
+				LoadFromWICFile(filePath.c_str(), forceSRGB ? WIC_FLAGS_DEFAULT_SRGB : WIC_FLAGS_NONE, nullptr, image),
+				filePath.string()
+			);
+			if (isDDS) {
+				if (forceSRGB) {
+					image.OverrideFormat(MakeSRGB(image.GetMetadata().format));
+				}
+			}
+			else if (generateMips) {
+				GenerateMips(image, compression == TextureCompression::NormalMap);
+			}
+			return image;
+		}
+
+		auto sourceFilePath = weakly_canonical(filePath).native();
+		ranges::transform(sourceFilePath, begin(sourceFilePath), towlower);
+		const auto sourceFileSize = file_size(filePath);
+		const uint64_t parameters[]{
+			TranscodeVersion, forceSRGB, static_cast<uint64_t>(compression), generateMips,
+			sourceFileSize, static_cast<uint64_t>(last_write_time(filePath).time_since_epoch().count())
+		};
+		const auto cacheFilePath = TranscodeCacheDirectoryPath / format("{:016X}.dds", HashContent(as_bytes(span(parameters)), HashContent(as_bytes(span(sourceFilePath)))));
+		if (error_code errorCode; exists(cacheFilePath, errorCode)
+			&& SUCCEEDED(LoadFromDDSFile(cacheFilePath.c_str(), DDS_FLAGS_NONE, nullptr, image))) {
+			return image;
+		}
+
+		vector<std::byte> data(sourceFileSize);
+		if (ifstream file(filePath, ios::binary); !file.read(reinterpret_cast<char*>(::data(data)), size(data))) {
+			Throw<runtime_error>(format("{}: Failed to read texture", filePath.string()));
+		}
+
+		ThrowIfFailed(
+			!_wcsicmp(extension, L"hdr") ? LoadFromHDRMemory(::data(data), size(data), nullptr, image) :
+			isEXR ? LoadFromEXRFile(filePath.c_str(), nullptr, image) :
+			!_wcsicmp(extension, L"tga") ? LoadFromTGAMemory(::data(data), size(data), forceSRGB ? TGA_FLAGS_DEFAULT_SRGB : TGA_FLAGS_NONE, nullptr, image) :
+			LoadFromWICMemory(::data(data), size(data), forceSRGB ? WIC_FLAGS_DEFAULT_SRGB : WIC_FLAGS_NONE, nullptr, image),
+			filePath.string()
+		);
+
+		if (generateMips) {
+			GenerateMips(image, compression == TextureCompression::NormalMap);
+		}
+
+		const auto& metadata = image.GetMetadata();
+		if (metadata.width % 4 || metadata.height % 4) {
+			return image;
+		}
+
+		DXGI_FORMAT compressedFormat;
+		switch (compression) {
+			case TextureCompression::NormalMap: compressedFormat = DXGI_FORMAT_BC5_UNORM; break;
+			case TextureCompression::SingleChannel: compressedFormat = DXGI_FORMAT_BC4_UNORM; break;
+			default:
+				compressedFormat = FormatDataType(metadata.format) == FORMAT_TYPE_FLOAT ? DXGI_FORMAT_BC6H_UF16 :
+					forceSRGB || IsSRGB(metadata.format) ? DXGI_FORMAT_BC7_UNORM_SRGB : DXGI_FORMAT_BC7_UNORM;
+				break;
+		}
+
+		ScratchImage compressedImage;
+		ThrowIfFailed(Compress(image.GetImages(), image.GetImageCount(), metadata, compressedFormat, TEX_COMPRESS_PARALLEL | TEX_COMPRESS_BC7_QUICK, TEX_THRESHOLD_DEFAULT, compressedImage), filePath.string());
+
+		try {
+			create_directories(TranscodeCacheDirectoryPath);
+
+			auto temporaryFilePath = cacheFilePath;
+			temporaryFilePath += format(L".{}.tmp", GetCurrentThreadId());
+			ThrowIfFailed(SaveToDDSFile(compressedImage.GetImages(), compressedImage.GetImageCount(), compressedImage.GetMetadata(), DDS_FLAGS_NONE, temporaryFilePath.c_str()));
+			rename(temporaryFilePath, cacheFilePath);
+		}
+		catch (...) {}
+
+		return compressedImage;
 	}
+
+	unique_ptr<Texture> LoadTexture(CommandList& commandList, const path& filePath, bool forceSRGB = false, TextureCompression compression = TextureCompression::Color, bool generateMips = true) {
+		return LoadTexture(commandList, DecodeTexture(filePath, forceSRGB, compression, generateMips));
+	}
+
+	class TextureResidencyManager {
+	public:
+		struct Statistics { uint64_t ResidentByteSize, RequestedByteSize; size_t StreamingCount, StreamedCount, EvictedCount; };
+
+		uint64_t Budget = 1ull << 31;
+		size_t TailSize = 128, MaxStreamingCount = 4;
+
+		TextureResidencyManager(const TextureResidencyManager&) = delete;
+		TextureResidencyManager& operator=(const TextureResidencyManager&) = delete;
+
+		explicit TextureResidencyManager(const DeviceContext& deviceContext) noexcept(false) : m_deviceContext(deviceContext) {
+			ThrowIfFailed(deviceContext.Device->CreateFence(m_fenceValue, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_fence)));
+		}
+
+		size_t GetTailMip(const TexMetadata& metadata) const { return GetFirstMip(metadata, TailSize); }
+
+		void Register(const shared_ptr<Texture>& texture, const TexMetadata& metadata, size_t firstMip, function<ScratchImage()> decode, function<void(const shared_ptr<Texture>&, size_t)> onReplaced = nullptr) {
+			m_indices[texture.get()] = size(m_entries);
+			m_entries.emplace_back(Entry{ .Texture = texture, .Metadata = metadata, .Decode = move(decode), .OnReplaced = move(onReplaced), .FirstMip = firstMip, .TailMip = firstMip });
+		}
+
+		void Request(const Texture& texture, float size) {
+			if (const auto pIndex = m_indices.find(&texture); pIndex != cend(m_indices)) {
+				auto& entry = m_entries[pIndex->second];
+				entry.RequestedSize = max(entry.RequestedSize, size);
+			}
+		}
+
+		unordered_map<const Texture*, shared_ptr<Texture>> Update(CommandList& commandList) {
+			ThrowIfFailed(m_deviceContext.CommandQueue->Signal(m_fence.Get(), ++m_fenceValue));
+			const auto completedFenceValue = m_fence->GetCompletedValue();
+			erase_if(m_retiredTextures, [&](const auto& retiredTexture) { return retiredTexture.first <= completedFenceValue; });
+
+			if (erase_if(m_entries, [](const Entry& entry) { return entry.Texture.expired(); })) {
+				m_indices.clear();
+				for (size_t i = 0; const auto& entry : m_entries) {
+					m_indices[entry.Texture.lock().get()] = i++;
+				}
+			}
+
+			m_statistics.RequestedByteSize = 0;
+			uint64_t targetByteSize = 0;
+			vector<size_t> order(size(m_entries));
+			for (size_t i = 0; auto& entry : m_entries) {
+				auto mip = entry.TailMip;
+				if (entry.RequestedSize > 0) {
+					mip = static_cast<size_t>(clamp(floor(log2(static_cast<float>(max(entry.Metadata.width, entry.Metadata.height)) / entry.RequestedSize)), 0.0f, static_cast<float>(entry.TailMip)));
+					while (mip && !IsValidFirstMip(entry.Metadata, mip)) {
+						mip--;
+					}
+				}
+				entry.Priority = exchange(entry.RequestedSize, 0.0f);
+				entry.TargetMip = entry.IsStreamable ? mip : max(mip, entry.FirstMip);
+				const auto byteSize = GetByteSize(entry.Metadata, mip);
+				m_statistics.RequestedByteSize += byteSize;
+				targetByteSize += byteSize;
+				order[i] = i;
+				i++;
+			}
+
+			ranges::sort(order, {}, [&](size_t index) { return m_entries[index].Priority; });
+			for (auto isCoarsened = true; targetByteSize > Budget && isCoarsened;) {
+				isCoarsened = false;
+				for (const auto index : order) {
+					auto& entry = m_entries[index];
+					auto mip = entry.TargetMip + 1;
+					while (mip < entry.TailMip && !IsValidFirstMip(entry.Metadata, mip)) {
+						mip++;
+					}
+					if (mip > entry.TailMip) {
+						continue;
+					}
+					targetByteSize -= GetByteSize(entry.Metadata, entry.TargetMip) - GetByteSize(entry.Metadata, mip);
+					entry.TargetMip = mip;
+					isCoarsened = true;
+					if (targetByteSize <= Budget) {
+						break;
+					}
+				}
+			}
+
+			unordered_map<const Texture*, shared_ptr<Texture>> replacements;
+			const auto Replace = [&](Entry& entry, shared_ptr<Texture> texture, unique_ptr<Texture> newTexture, size_t firstMip) {
+				commandList.SetState(*newTexture, D3D12_RESOURCE_STATE_ALL_SHADER_RESOURCE);
+				newTexture->CreateSRV();
+
+				shared_ptr replacement = move(newTexture);
+				m_indices[replacement.get()] = m_indices.extract(texture.get()).mapped();
+				entry.Texture = replacement;
+				entry.FirstMip = firstMip;
+				if (entry.OnReplaced) {
+					entry.OnReplaced(replacement, firstMip);
+				}
+				replacements[texture.get()] = move(replacement);
+				m_retiredTextures.emplace_back(m_fenceValue + 1, move(texture));
+			};
+
+			size_t streamingCount = 0;
+			for (const auto& entry : m_entries) {
+				streamingCount += entry.Streaming.valid();
+			}
+
+			m_statistics.ResidentByteSize = 0;
+			for (auto& entry : m_entries) {
+				auto texture = entry.Texture.lock();
+
+				if (entry.Streaming.valid() && entry.Streaming.wait_for(0s) == future_status::ready) {
+					streamingCount--;
+					ScratchImage image;
+					try {
+						image = entry.Streaming.get();
+					}
+					catch (...) {
+						entry.IsStreamable = false;
+					}
+					if (entry.IsStreamable && image.GetMetadata().mipLevels != entry.Metadata.mipLevels) {
+						entry.IsStreamable = false;
+					}
+					if (entry.IsStreamable && entry.StreamingMip < entry.FirstMip) {
+						auto newTexture = CreateTexture(m_deviceContext, image.GetMetadata(), false, entry.StreamingMip);
+						commandList.Copy(*newTexture, GetSubresourceData(m_deviceContext, image, entry.StreamingMip));
+						Replace(entry, texture, move(newTexture), entry.StreamingMip);
+						m_statistics.StreamedCount++;
+					}
+				}
+
+				if (!entry.Streaming.valid()) {
+					if (entry.TargetMip < entry.FirstMip) {
+						if (streamingCount < MaxStreamingCount) {
+							entry.StreamingMip = entry.TargetMip;
+							entry.Streaming = StartTask(TaskPriority::Low, entry.Decode);
+							streamingCount++;
+						}
+					}
+					else if (entry.TargetMip > entry.FirstMip) {
+						const auto& metadata = entry.Metadata;
+						auto newTexture = CreateTexture(m_deviceContext, metadata, false, entry.TargetMip);
+
+						commandList.SetState(*texture, D3D12_RESOURCE_STATE_COPY_SOURCE);
+						commandList.SetState(*newTexture, D3D12_RESOURCE_STATE_COPY_DEST);
+						const auto arraySize = static_cast<UINT>(metadata.dimension == TEX_DIMENSION_TEXTURE3D ? 1 : metadata.arraySize);
+						const auto sourceMipLevels = static_cast<UINT>(metadata.mipLevels - entry.FirstMip), destinationMipLevels = static_cast<UINT>(metadata.mipLevels - entry.TargetMip);
+						for (UINT item = 0; item < arraySize; item++) {
+							for (UINT mip = 0; mip < destinationMipLevels; mip++) {
+								const CD3DX12_TEXTURE_COPY_LOCATION
+									destination(*newTexture, D3D12CalcSubresource(mip, item, 0, destinationMipLevels, arraySize)),
+									source(*texture, D3D12CalcSubresource(mip + static_cast<UINT>(entry.TargetMip - entry.FirstMip), item, 0, sourceMipLevels, arraySize));
+								commandList->CopyTextureRegion(&destination, 0, 0, 0, &source, nullptr);
+							}
+						}
+
+						Replace(entry, texture, move(newTexture), entry.TargetMip);
+						m_statistics.EvictedCount++;
+					}
+				}
+
+				m_statistics.ResidentByteSize += GetByteSize(entry.Metadata, entry.FirstMip);
+			}
+			m_statistics.StreamingCount = streamingCount;
+
+			return replacements;
+		}
+
+		const Statistics& GetStatistics() const noexcept { return m_statistics; }
+
+	private:
+		const DeviceContext& m_deviceContext;
+
+		struct Entry {
+			weak_ptr<Texture> Texture;
+			TexMetadata Metadata;
+			function<ScratchImage()> Decode;
+			function<void(const shared_ptr<Texture>&, size_t)> OnReplaced;
+			size_t FirstMip, TailMip, TargetMip{}, StreamingMip{};
+			float RequestedSize{}, Priority{};
+			future<ScratchImage> Streaming;
+			bool IsStreamable = true;
+		};
+		vector<Entry> m_entries;
+		unordered_map<const Texture*, size_t> m_indices;
+
+		ComPtr<ID3D12Fence> m_fence;
+		UINT64 m_fenceValue{};
+		vector<pair<UINT64, shared_ptr<Texture>>> m_retiredTextures;
+
+		Statistics m_statistics{};
+	};
+
+	class TextureCache {
+	public:
+		struct Statistics { uint64_t RequestCount, HitCount, SavedByteSize; };
+
+		struct Request {
+			path FilePath;
+			bool IsSRGB;
+			TextureCompression Compression = TextureCompression::Color;
+			bool GenerateMips = true;
+		};
+
+		vector<shared_ptr<Texture>> Load(CommandList& commandList, span<const Request> requests, TextureResidencyManager* pResidencyManager = nullptr) {
+			vector<shared_ptr<Texture>> textures(size(requests));
+
+			struct Miss {
+				Key Key;
+				path FilePath;
+				vector<size_t> Indices;
+			};
+			vector<Miss> misses;
+			unordered_map<Key, size_t, KeyHasher> missIndices;
+			for (size_t i = 0; const auto& [FilePath, IsSRGB, Compression, GenerateMips] : requests) {
+				m_statistics.RequestCount++;
+
+				Key key{ .FilePath = weakly_canonical(FilePath).native(), .IsSRGB = IsSRGB, .Compression = Compression, .GenerateMips = GenerateMips };
+				ranges::transform(key.FilePath, begin(key.FilePath), towlower);
+
+				if (const auto pEntry = m_entries.find(key); pEntry != cend(m_entries)) {
+					if (auto texture = pEntry->second.Texture.lock()) {
+						m_statistics.HitCount++;
+						m_statistics.SavedByteSize += pEntry->second.ByteSize;
+						textures[i++] = move(texture);
+						continue;
+					}
+				}
+
+				const auto [pMissIndex, isInserted] = missIndices.try_emplace(key, size(misses));
+				if (isInserted) {
+					misses.emplace_back(move(key), FilePath);
+				}
+				else {
+					m_statistics.HitCount++;
+				}
+				misses[pMissIndex->second].Indices.emplace_back(i++);
+			}
+
+			if (empty(misses)) {
+				return textures;
+			}
+
+			vector<ScratchImage> images(size(misses));
+			exception_ptr exception;
+			mutex exceptionMutex;
+			ParallelFor(size(misses), 1, [&](size_t first, size_t last) {
+				try {
+					for (auto i = first; i < last; i++) {
+						images[i] = DecodeTexture(misses[i].FilePath, misses[i].Key.IsSRGB, misses[i].Key.Compression, misses[i].Key.GenerateMips);
+					}
+				}
+				catch (...) {
+					const scoped_lock lock(exceptionMutex);
+
+					if (!exception) {
+						exception = current_exception();
+					}
+				}
+			});
+			if (exception) {
+				rethrow_exception(exception);
+			}
+
+			vector<size_t> firstMips;
+			if (pResidencyManager != nullptr) {
+				firstMips.reserve(size(images));
+				for (const auto& image : images) {
+					firstMips.emplace_back(pResidencyManager->GetTailMip(image.GetMetadata()));
+				}
+			}
+
+			for (size_t i = 0; auto& loadedTexture : LoadTextures(commandList, images, firstMips)) {
+				const auto& [Key, FilePath, Indices] = misses[i];
+				const auto& metadata = images[i].GetMetadata();
+				const auto byteSize = GetByteSize(metadata, empty(firstMips) ? 0 : firstMips[i]);
+
+				const shared_ptr texture = move(loadedTexture);
+				m_entries[Key] = { texture, byteSize };
+				if (pResidencyManager != nullptr) {
+					pResidencyManager->Register(
+						texture, metadata, firstMips[i],
+						[FilePath, IsSRGB = Key.IsSRGB, Compression = Key.Compression, GenerateMips = Key.GenerateMips] { return DecodeTexture(FilePath, IsSRGB, Compression, GenerateMips); },
+						[this, Key, metadata](const shared_ptr<Texture>& replacement, size_t firstMip) { m_entries[Key] = { replacement, GetByteSize(metadata, firstMip) }; }
+					);
+				}
+				i++;
+				for (const auto index : Indices) {
+					textures[index] = texture;
+				}
+				m_statistics.SavedByteSize += byteSize * (size(Indices) - 1);
+			}
+
+			return textures;
+		}
+
+		const Statistics& GetStatistics() const noexcept { return m_statistics; }
+
+	private:
+		struct Key {
+			wstring FilePath;
+			bool IsSRGB;
+			TextureCompression Compression;
+			bool GenerateMips;
+
+			bool operator==(const Key&) const = default;
+		};
+
+		struct KeyHasher {
+			size_t operator()(const Key& key) const noexcept { return hash<wstring>()(key.FilePath) ^ static_cast<size_t>(key.IsSRGB) ^ (static_cast<size_t>(key.Compression) << 1) ^ (static_cast<size_t>(key.GenerateMips) << 3); }
+		};
+
+		struct Entry {
+			weak_ptr<Texture> Texture;
+			uint64_t ByteSize;
+		};
+
+		unordered_map<Key, Entry, KeyHasher> m_entries;
+
+		Statistics m_statistics{};
+	};
 }
@@ -1,26 +1,268 @@
 module;
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
 #include <future>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
 
 export module ThreadHelpers;
 
 using namespace std;
 
 export namespace ThreadHelpers {
+	enum class TaskPriority { High, Normal, Low, Count };
+
+	class TaskScheduler {
+	public:
+		struct Statistics {
+			size_t ThreadCount, QueueDepth, MaxQueueDepth;
+			uint64_t SubmittedCount, ExecutedCount, StolenCount;
+		};
+
+		TaskScheduler(const TaskScheduler&) = delete;
+		TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+		explicit TaskScheduler(size_t threadCount = max(thread::hardware_concurrency(), 2u) - 1) : m_workers(max(threadCount, size_t{ 1 })) {
+			m_threads.reserve(size(m_workers));
+			for (size_t i = 0; i < size(m_workers); i++) {
+				m_threads.emplace_back([this, i](stop_token stopToken) { Run(stopToken, i); });
+			}
+		}
+
+		~TaskScheduler() {
+			for (auto& thread : m_threads) {
+				thread.request_stop();
+			}
+			m_threads.clear();
+		}
+
+		static TaskScheduler& Get() {
+			static TaskScheduler s_taskScheduler;
+			return s_taskScheduler;
+		}
+
+		size_t GetThreadCount() const noexcept { return size(m_workers); }
+
+		Statistics GetStatistics() const noexcept {
+			return {
+				.ThreadCount = size(m_workers),
+				.QueueDepth = m_queueDepth.load(memory_order_relaxed),
+				.MaxQueueDepth = m_maxQueueDepth.load(memory_order_relaxed),
+				.SubmittedCount = m_submittedCount.load(memory_order_relaxed),
+				.ExecutedCount = m_executedCount.load(memory_order_relaxed),
+				.StolenCount = m_stolenCount.load(memory_order_relaxed)
+			};
+		}
+
+		void Submit(move_only_function<void()> task, TaskPriority priority = TaskPriority::Normal) {
+			m_submittedCount.fetch_add(1, memory_order_relaxed);
+			const auto queueDepth = m_queueDepth.fetch_add(1, memory_order_release) + 1;
+			for (auto maxQueueDepth = m_maxQueueDepth.load(memory_order_relaxed);
+				queueDepth > maxQueueDepth && !m_maxQueueDepth.compare_exchange_weak(maxQueueDepth, queueDepth, memory_order_relaxed);) {
+			}
+
+			{
+				auto& worker = m_workers[s_pTaskScheduler == this ? s_workerIndex : m_nextWorkerIndex.fetch_add(1, memory_order_relaxed) % size(m_workers)];
+				const scoped_lock lock(worker.Mutex);
+				worker.Queues[to_underlying(priority)].emplace_back(move(task));
+			}
+
+			{
+				const scoped_lock lock(m_mutex);
+			}
+			m_condition.notify_one();
+		}
+
+		bool TryExecute(TaskPriority maxPriority = TaskPriority::Low) {
+			auto task = Dequeue(s_pTaskScheduler == this ? s_workerIndex : m_nextWorkerIndex.load(memory_order_relaxed) % size(m_workers), maxPriority);
+			if (!task) {
+				return false;
+			}
+			task();
+			m_executedCount.fetch_add(1, memory_order_relaxed);
+			return true;
+		}
+
+	private:
+		struct Worker {
+			mutex Mutex;
+			deque<move_only_function<void()>> Queues[to_underlying(TaskPriority::Count)];
+		};
+
+		inline static thread_local const TaskScheduler* s_pTaskScheduler;
+		inline static thread_local size_t s_workerIndex;
+
+		vector<Worker> m_workers;
+		vector<jthread> m_threads;
+
+		mutex m_mutex;
+		condition_variable_any m_condition;
+
+		atomic<size_t> m_nextWorkerIndex, m_queueDepth, m_maxQueueDepth;
+		atomic<uint64_t> m_submittedCount, m_executedCount, m_stolenCount;
+
+		move_only_function<void()> Dequeue(size_t workerIndex, TaskPriority maxPriority) {
+			if (!m_queueDepth.load(memory_order_acquire)) {
+				return {};
+			}
+
+			for (size_t priority = 0; priority <= to_underlying(maxPriority); priority++) {
+				for (size_t i = 0; i < size(m_workers); i++) {
+					auto& worker = m_workers[(workerIndex + i) % size(m_workers)];
+					const scoped_lock lock(worker.Mutex);
+					if (auto& queue = worker.Queues[priority]; !empty(queue)) {
+						auto task = move(i ? queue.front() : queue.back());
+						if (i) {
+							queue.pop_front();
+							m_stolenCount.fetch_add(1, memory_order_relaxed);
+						}
+						else {
+							queue.pop_back();
+						}
+						m_queueDepth.fetch_sub(1, memory_order_relaxed);
+						return task;
+					}
+				}
+			}
+			return {};
+		}
+
+		void Run(stop_token stopToken, size_t workerIndex) {
+			s_pTaskScheduler = this;
+			s_workerIndex = workerIndex;
+			while (!stopToken.stop_requested()) {
+				if (TryExecute()) {
+					continue;
+				}
+
+				unique_lock lock(m_mutex);
+				m_condition.wait(lock, stopToken, [&] { return m_queueDepth.load(memory_order_acquire) > 0; });
+			}
+		}
+	};
+
+	template <typename Function>
+	auto StartTask(TaskPriority priority, Function&& function) {
+		using ResultType = invoke_result_t<Function>;
+		promise<ResultType> promise;
+		auto future = promise.get_future();
+		TaskScheduler::Get().Submit([function = forward<Function>(function), promise = move(promise)]() mutable {
+			try {
+				if constexpr (is_same_v<ResultType, void>) {
+					function();
+					promise.set_value();
+				}
+				else {
+					promise.set_value(function());
+				}
+			}
+			catch (...) { promise.set_exception(current_exception()); }
+		}, priority);
+		return future;
+	}
+
 	template <typename Function, typename... Args>
 	auto StartDetachedFuture(Function&& function, Args&&... args) {
 		using ResultType = invoke_result_t<Function, Args...>;
 		promise<ResultType> promise;
 		auto future = promise.get_future();
-		thread([function, ...args = forward<Args>(args), promise = move(promise)]() mutable {
-			if constexpr (is_same_v<ResultType, void>) {
-				function(forward<Args>(args)...);
-				promise.set_value();
-			}
-			else {
-				promise.set_value(function(forward<Args>(args)...));
+		thread([function = forward<Function>(function), ...args = forward<Args>(args), promise = move(promise)]() mutable {
+			try {
+				if constexpr (is_same_v<ResultType, void>) {
+					function(forward<Args>(args)...);
+					promise.set_value();
+				}
+				else {
+					promise.set_value(function(forward<Args>(args)...));
+				}
 			}
+			catch (...) { promise.set_exception(current_exception()); }
 		}).detach();
 		return future;
 	}
+
+	template <typename Function>
+	void ParallelFor(size_t count, size_t batchSize, Function&& function) {
+		const auto batchCount = (count + batchSize - 1) / batchSize;
+		if (batchCount < 2) {
+			if (count) {
+				function(0, count);
+			}
+			return;
+		}
+
+		auto& taskScheduler = TaskScheduler::Get();
+
+		atomic<size_t> remainingCount = batchCount;
+		exception_ptr exception;
+		mutex exceptionMutex;
+		const auto Execute = [&](size_t batchIndex) {
+			try {
+				const auto first = batchIndex * batchSize;
+				function(first, min(first + batchSize, count));
+			}
+			catch (...) {
+				const scoped_lock lock(exceptionMutex);
+				if (!exception) {
+					exception = current_exception();
+				}
+			}
+			remainingCount.fetch_sub(1, memory_order_acq_rel);
+		};
+
+		const auto nextBatchIndex = make_shared<atomic<size_t>>(0);
+		for (size_t i = 1; i < min(batchCount, taskScheduler.GetThreadCount() + 1); i++) {
+			taskScheduler.Submit([nextBatchIndex, batchCount, &Execute] {
+				for (size_t batchIndex; (batchIndex = nextBatchIndex->fetch_add(1, memory_order_relaxed)) < batchCount;) {
+					Execute(batchIndex);
+				}
+			}, TaskPriority::High);
+		}
+		for (size_t batchIndex; (batchIndex = nextBatchIndex->fetch_add(1, memory_order_relaxed)) < batchCount;) {
+			Execute(batchIndex);
+		}
+
+		while (remainingCount.load(memory_order_acquire)) {
+			this_thread::yield();
+		}
+
+		if (exception) {
+			rethrow_exception(exception);
+		}
+	}
+
+	template <typename T>
+	class TripleBuffer {
+	public:
+		T& GetBack() noexcept { return m_buffers[m_back]; }
+
+		T& GetFront() noexcept { return m_buffers[m_front]; }
+		const T& GetFront() const noexcept { return m_buffers[m_front]; }
+
+		void Publish() noexcept { m_back = m_middle.exchange(m_back | UpdatedFlag, memory_order_acq_rel) & IndexMask; }
+
+		bool HasUpdate() const noexcept { return m_middle.load(memory_order_acquire) & UpdatedFlag; }
+
+		bool Consume() noexcept {
+			if (!HasUpdate()) {
+				return false;
+			}
+			m_front = m_middle.exchange(m_front, memory_order_acq_rel) & IndexMask;
+			return true;
+		}
+
+	private:
+		static constexpr uint8_t IndexMask = 0b11, UpdatedFlag = 0b100;
+
+		T m_buffers[3]{};
+		uint8_t m_back = 0, m_front = 1;
+		atomic<uint8_t> m_middle = 2;
+	};
 }
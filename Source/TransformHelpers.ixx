@@ -0,0 +1,104 @@
+module;
+
+#include <DirectXMath.h>
+
+#include <Windows.h>
+
+#include <immintrin.h>
+
+export module TransformHelpers;
+
+using namespace DirectX;
+using namespace std;
+
+namespace {
+	bool IsAVXSupported() {
+		static const bool isSupported = IsProcessorFeaturePresent(PF_AVX_INSTRUCTIONS_AVAILABLE);
+		return isSupported;
+	}
+}
+
+export namespace TransformHelpers {
+	struct PoseBatch {
+		static constexpr size_t Capacity = 256;
+
+		size_t Count{};
+		alignas(32) float Rotation[4][Capacity], Translation[3][Capacity], Scale[Capacity], Bias[3][Capacity];
+
+		void Add(const XMFLOAT4& rotation, const XMFLOAT3& translation, float scale, float positionScale, const XMFLOAT3& positionBias) {
+			Rotation[0][Count] = rotation.x;
+			Rotation[1][Count] = rotation.y;
+			Rotation[2][Count] = rotation.z;
+			Rotation[3][Count] = rotation.w;
+			Translation[0][Count] = translation.x;
+			Translation[1][Count] = translation.y;
+			Translation[2][Count] = translation.z;
+			Scale[Count] = scale * positionScale;
+			Bias[0][Count] = positionBias.x * scale;
+			Bias[1][Count] = positionBias.y * scale;
+			Bias[2][Count] = positionBias.z * scale;
+			Count++;
+		}
+	};
+
+	void ComputeFlippedObjectToWorld(const PoseBatch& poses, XMFLOAT3X4* transforms) {
+		constexpr float Flips[]{ 1, 1, -1 };
+
+		size_t i = 0;
+
+		if (IsAVXSupported()) {
+			const auto one = _mm256_set1_ps(1), two = _mm256_set1_ps(2);
+			for (; i + 8 <= poses.Count; i += 8) {
+				const auto x = _mm256_load_ps(poses.Rotation[0] + i), y = _mm256_load_ps(poses.Rotation[1] + i), z = _mm256_load_ps(poses.Rotation[2] + i), w = _mm256_load_ps(poses.Rotation[3] + i);
+				const auto xx = _mm256_mul_ps(x, x), yy = _mm256_mul_ps(y, y), zz = _mm256_mul_ps(z, z);
+				const auto xy = _mm256_mul_ps(x, y), xz = _mm256_mul_ps(x, z), yz = _mm256_mul_ps(y, z);
+				const auto wx = _mm256_mul_ps(w, x), wy = _mm256_mul_ps(w, y), wz = _mm256_mul_ps(w, z);
+				const __m256 rotation[3][3]{
+					{ _mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(yy, zz))), _mm256_mul_ps(two, _mm256_sub_ps(xy, wz)), _mm256_mul_ps(two, _mm256_add_ps(xz, wy)) },
+					{ _mm256_mul_ps(two, _mm256_add_ps(xy, wz)), _mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(xx, zz))), _mm256_mul_ps(two, _mm256_sub_ps(yz, wx)) },
+					{ _mm256_mul_ps(two, _mm256_sub_ps(xz, wy)), _mm256_mul_ps(two, _mm256_add_ps(yz, wx)), _mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(xx, yy))) }
+				};
+				const auto scale = _mm256_load_ps(poses.Scale + i);
+				const __m256 bias[]{ _mm256_load_ps(poses.Bias[0] + i), _mm256_load_ps(poses.Bias[1] + i), _mm256_load_ps(poses.Bias[2] + i) };
+
+				alignas(32) float values[3][4][8];
+				for (size_t row = 0; row < 3; row++) {
+					const auto flip = _mm256_set1_ps(Flips[row]), flippedScale = _mm256_mul_ps(flip, scale);
+					auto translation = _mm256_load_ps(poses.Translation[row] + i);
+					for (size_t column = 0; column < 3; column++) {
+						_mm256_store_ps(values[row][column], _mm256_mul_ps(flippedScale, rotation[row][column]));
+						translation = _mm256_add_ps(translation, _mm256_mul_ps(rotation[row][column], bias[column]));
+					}
+					_mm256_store_ps(values[row][3], _mm256_mul_ps(flip, translation));
+				}
+
+				for (size_t lane = 0; lane < 8; lane++) {
+					auto& transform = transforms[i + lane];
+					for (size_t row = 0; row < 3; row++) {
+						for (size_t column = 0; column < 4; column++) {
+							transform.m[row][column] = values[row][column][lane];
+						}
+					}
+				}
+			}
+		}
+
+		for (; i < poses.Count; i++) {
+			const float x = poses.Rotation[0][i], y = poses.Rotation[1][i], z = poses.Rotation[2][i], w = poses.Rotation[3][i];
+			const float rotation[3][3]{
+				{ 1 - 2 * (y * y + z * z), 2 * (x * y - w * z), 2 * (x * z + w * y) },
+				{ 2 * (x * y + w * z), 1 - 2 * (x * x + z * z), 2 * (y * z - w * x) },
+				{ 2 * (x * z - w * y), 2 * (y * z + w * x), 1 - 2 * (x * x + y * y) }
+			};
+			auto& transform = transforms[i];
+			for (size_t row = 0; row < 3; row++) {
+				auto translation = poses.Translation[row][i];
+				for (size_t column = 0; column < 3; column++) {
+					transform.m[row][column] = Flips[row] * poses.Scale[i] * rotation[row][column];
+					translation += rotation[row][column] * poses.Bias[column][i];
+				}
+				transform.m[row][3] = Flips[row] * translation;
+			}
+		}
+	}
+}
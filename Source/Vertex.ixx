@@ -2,6 +2,8 @@ module;
 
 #include <DirectXPackedVector.h>
 
+#include <dxgiformat.h>
+
 #include "ml.h"
 
 export module Vertex;
@@ -28,8 +30,8 @@ namespace {
 
 export {
 	struct VertexDesc {
-		uint32_t Stride{};
-		XMUINT3 _;
+		uint32_t Stride{}, PositionFormat = DXGI_FORMAT_R32G32B32_FLOAT;
+		XMUINT2 _;
 		struct {
 			uint32_t Normal = ~0u, Tangent = ~0u, TextureCoordinates[2]{ ~0u, ~0u };
 		} AttributeOffsets;
@@ -48,4 +50,14 @@ export {
 			TextureCoordinates[index] = EncodeTextureCoordinate(value);
 		}
 	};
+
+	struct QuantizedVertexPositionNormalTangentTexture {
+		XMSHORTN4 Position;
+		int16_t3 Normal, Tangent;
+		XMHALF2 TextureCoordinates[2];
+
+		void StorePosition(const XMFLOAT3& value, const XMFLOAT3& bias, float scale) {
+			XMStoreShortN4(&Position, XMVectorSetW((XMLoadFloat3(&value) - XMLoadFloat3(&bias)) / scale, 0));
+		}
+	};
 }